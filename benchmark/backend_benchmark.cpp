@@ -0,0 +1,122 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include "benchmark.hpp"
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/pthread_shared_mutex.hpp>
+#include <shared_recursive_mutex/queued_shared_mutex.hpp>
+#include <shared_recursive_mutex/cohort_shared_mutex.hpp>
+#include <shared_recursive_mutex/bravo_shared_mutex.hpp>
+#include <shared_mutex>
+#include <mutex>
+#include <string>
+
+constexpr uint64_t numIterations = 1000000;
+constexpr uint64_t writeEvery = 100;
+
+//measures the first level acquisitions of a backend, which is what the shared_recursive_mutex_t pays for the outermost lock
+template<typename Mutex>
+void benchmark_backend(const std::string& name)
+{
+	{
+		Mutex mutex;
+		const double seconds = bench::run_parallel(1, [&](unsigned) {
+			for (uint64_t i = 0; i < numIterations; ++i)
+			{
+				mutex.lock_shared();
+				mutex.unlock_shared();
+			}
+		});
+		bench::report(name + " uncontended lock_shared", 1, numIterations, seconds);
+	}
+	{
+		Mutex mutex;
+		const double seconds = bench::run_parallel(1, [&](unsigned) {
+			for (uint64_t i = 0; i < numIterations; ++i)
+			{
+				mutex.lock();
+				mutex.unlock();
+			}
+		});
+		bench::report(name + " uncontended lock", 1, numIterations, seconds);
+	}
+	for (unsigned numThreads : bench::thread_counts())
+	{
+		Mutex mutex;
+		uint64_t counter = 0;
+		std::atomic<uint64_t> observed{ 0 };
+		const double seconds = bench::run_parallel(numThreads, [&](unsigned) {
+			uint64_t sum = 0;
+			for (uint64_t i = 0; i < numIterations; ++i)
+			{
+				if (i % writeEvery == 0)
+				{
+					std::unique_lock lock(mutex);
+					++counter;
+				}
+				else
+				{
+					std::shared_lock lock(mutex);
+					sum += counter;
+				}
+			}
+			observed += sum;
+		});
+		bench::report(name + " read mostly (1% writes)", numThreads, numThreads * numIterations, seconds);
+	}
+}
+
+//same workload through the recursion layer, with a nested read lock and the read to write upgrade from example.cpp
+template<typename Backend>
+void benchmark_recursive(const std::string& name)
+{
+	auto& mutex = mtx::shared_recursive_mutex_t<struct BenchmarkType, Backend>::instance();
+	for (unsigned numThreads : bench::thread_counts())
+	{
+		uint64_t counter = 0;
+		std::atomic<uint64_t> observed{ 0 };
+		const double seconds = bench::run_parallel(numThreads, [&](unsigned) {
+			uint64_t sum = 0;
+			for (uint64_t i = 0; i < numIterations; ++i)
+			{
+				std::shared_lock read_guard(mutex);
+				std::shared_lock nested_read_guard(mutex);
+				sum += counter;
+				if (i % writeEvery == 0)
+				{
+					std::unique_lock write_guard(mutex);
+					++counter;
+				}
+			}
+			observed += sum;
+		});
+		bench::report("shared_recursive_mutex_t<" + name + ">", numThreads, numThreads * numIterations, seconds);
+	}
+}
+
+int main()
+{
+	benchmark_backend<std::shared_mutex>("std::shared_mutex");
+	benchmark_backend<std::shared_timed_mutex>("std::shared_timed_mutex");
+#if defined(SHARED_RECURSIVE_MUTEX_HAS_PTHREAD)
+	benchmark_backend<mtx::pthread_shared_mutex<>>("mtx::pthread_shared_mutex");
+#endif
+#if defined(__GLIBC__)
+	benchmark_backend<mtx::pthread_shared_mutex<mtx::pthread_rwlock_preference::prefer_writer_nonrecursive>>("mtx::pthread_shared_mutex (prefer writer)");
+#endif
+	benchmark_backend<mtx::shared_futex_mutex>("mtx::shared_futex_mutex");
+	benchmark_backend<mtx::basic_shared_futex_mutex<mtx::adaptive_spin_wait_policy<>>>("mtx::shared_futex_mutex (adaptive spin)");
+	benchmark_backend<mtx::queued_shared_mutex>("mtx::queued_shared_mutex");
+	benchmark_backend<mtx::cohort_shared_mutex<>>("mtx::cohort_shared_mutex");
+	benchmark_backend<mtx::bravo_shared_mutex<>>("mtx::bravo_shared_mutex");
+
+	benchmark_recursive<std::shared_mutex>("std::shared_mutex");
+#if defined(SHARED_RECURSIVE_MUTEX_HAS_PTHREAD)
+	benchmark_recursive<mtx::pthread_shared_mutex<>>("mtx::pthread_shared_mutex");
+#endif
+	benchmark_recursive<mtx::shared_futex_mutex>("mtx::shared_futex_mutex");
+	benchmark_recursive<mtx::basic_shared_futex_mutex<mtx::adaptive_spin_wait_policy<>>>("mtx::shared_futex_mutex (adaptive spin)");
+	benchmark_recursive<mtx::queued_shared_mutex>("mtx::queued_shared_mutex");
+	benchmark_recursive<mtx::cohort_shared_mutex<>>("mtx::cohort_shared_mutex");
+	benchmark_recursive<mtx::bravo_shared_mutex<>>("mtx::bravo_shared_mutex");
+}
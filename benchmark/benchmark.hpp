@@ -0,0 +1,82 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench
+{
+	//runs body(threadIndex) on the given number of threads, all threads start at the same time
+	//returns the wall clock time in seconds until the last thread is done
+	template<typename Body>
+	double run_parallel(unsigned numThreads, Body&& body)
+	{
+		std::atomic<unsigned> ready{ 0 };
+		std::atomic<bool> go{ false };
+		std::vector<std::thread> threads;
+		threads.reserve(numThreads);
+		for (unsigned i = 0; i < numThreads; ++i)
+		{
+			threads.emplace_back([&, i]() {
+				++ready;
+				while (!go.load(std::memory_order_acquire))
+					std::this_thread::yield();
+				body(i);
+			});
+		}
+		while (ready.load() != numThreads)
+			std::this_thread::yield();
+
+		using namespace std::chrono;
+		const auto t1 = steady_clock::now();
+		go.store(true, std::memory_order_release);
+		for (auto& thread : threads)
+			thread.join();
+		const auto t2 = steady_clock::now();
+		return duration_cast<duration<double>>(t2 - t1).count();
+	}
+
+	//thread counts to measure scaling with: 1, 2, 4, ... up to twice the hardware concurrency
+	inline std::vector<unsigned> thread_counts()
+	{
+		const unsigned maxThreads = std::max(2u, 2 * std::thread::hardware_concurrency());
+		std::vector<unsigned> counts;
+		for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+			counts.push_back(threads);
+		return counts;
+	}
+
+	inline void report(const std::string& name, unsigned numThreads, uint64_t operations, double seconds)
+	{
+		std::cout << std::left << std::setw(56) << name
+			<< " threads: " << std::setw(4) << numThreads
+			<< std::right << std::fixed << std::setprecision(2)
+			<< std::setw(10) << seconds * 1e9 / static_cast<double>(operations) << " ns/op"
+			<< std::setw(10) << static_cast<double>(operations) / seconds / 1e6 << " Mops/s\n";
+	}
+
+	//prints the average, the 99th percentile and the maximum of the measured latencies (in nanoseconds)
+	inline void report_latency(const std::string& name, unsigned numThreads, std::vector<double> latencies)
+	{
+		if (latencies.empty())
+			return;
+		std::sort(latencies.begin(), latencies.end());
+		double sum = 0;
+		for (double latency : latencies)
+			sum += latency;
+		std::cout << std::left << std::setw(56) << name
+			<< " threads: " << std::setw(4) << numThreads
+			<< std::right << std::fixed << std::setprecision(0)
+			<< " avg: " << std::setw(10) << sum / static_cast<double>(latencies.size()) << " ns"
+			<< " p99: " << std::setw(10) << latencies[latencies.size() * 99 / 100] << " ns"
+			<< " max: " << std::setw(10) << latencies.back() << " ns\n";
+	}
+}
@@ -0,0 +1,51 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include "benchmark.hpp"
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_mutex>
+#include <mutex>
+#include <string>
+
+constexpr uint64_t numIterations = 200000;
+constexpr unsigned threadCounts[] = { 1, 4, 16, 64 };
+
+//the pattern of the example: every thread reads and upgrades every writeEvery-th iteration to increment a counter.
+//with combine the increments of the waiting threads are executed by the thread that gets the write lock, in one batch
+template<bool Combine>
+void benchmark_increments(const std::string& name, uint64_t writeEvery)
+{
+	auto& mutex = mtx::shared_recursive_mutex_t<struct CombineBenchType>::instance();
+	for (unsigned numThreads : threadCounts)
+	{
+		uint64_t counter = 0;
+		const uint64_t iterations = numIterations / numThreads;
+		const double seconds = bench::run_parallel(numThreads, [&](unsigned) {
+			for (uint64_t i = 0; i < iterations; ++i)
+			{
+				std::shared_lock read_guard(mutex);
+				if (i % writeEvery != 0)
+					continue;
+				if constexpr (Combine)
+				{
+					mutex.combine([&]() { ++counter; });
+				}
+				else
+				{
+					std::unique_lock write_guard(mutex);
+					++counter;
+				}
+			}
+		});
+		bench::report(name + " write every " + std::to_string(writeEvery), numThreads, numThreads * iterations, seconds);
+	}
+}
+
+int main()
+{
+	for (uint64_t writeEvery : { 20, 2, 1 })
+	{
+		benchmark_increments<false>("upgrade to write lock", writeEvery);
+		benchmark_increments<true>("combine", writeEvery);
+	}
+}
@@ -0,0 +1,80 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include "benchmark.hpp"
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/compact_shared_recursive_mutex.hpp>
+#include <memory>
+#include <shared_mutex>
+#include <mutex>
+#include <string>
+
+constexpr std::size_t numEntries = 1 << 20;
+constexpr uint64_t numAccesses = 2000000;
+constexpr uint64_t writeEvery = 10;
+
+template<typename Mutex>
+struct entry
+{
+	Mutex mutex;
+	uint64_t value = 0;
+};
+
+//the memory one lock per object costs, for the 50 million entries of a large cache
+template<typename Mutex>
+void report_footprint(const std::string& name)
+{
+	constexpr double entries = 50e6;
+	std::cout << std::left << std::setw(56) << name
+		<< " sizeof: " << std::setw(4) << sizeof(Mutex)
+		<< " entry: " << std::setw(4) << sizeof(entry<Mutex>)
+		<< std::right << std::fixed << std::setprecision(2)
+		<< " locks of 50M entries: " << std::setw(8) << entries * static_cast<double>(sizeof(Mutex)) / (1 << 30) << " GiB\n";
+}
+
+//every thread accesses random entries of a large table, every writeEvery-th access is a write.
+//the smaller the lock, the more entries fit into the cache
+template<typename Mutex>
+void benchmark_per_object_locks(const std::string& name)
+{
+	auto entries = std::make_unique<entry<Mutex>[]>(numEntries);
+	for (unsigned numThreads : bench::thread_counts())
+	{
+		std::atomic<uint64_t> observed{ 0 };
+		const double seconds = bench::run_parallel(numThreads, [&](unsigned thread) {
+			uint64_t random = 0x9E3779B97F4A7C15ull * (thread + 1);
+			uint64_t sum = 0;
+			for (uint64_t i = 0; i < numAccesses; ++i)
+			{
+				//xorshift, cheap enough to not hide the cost of the lock
+				random ^= random << 13;
+				random ^= random >> 7;
+				random ^= random << 17;
+				auto& current = entries[random % numEntries];
+				if (i % writeEvery == 0)
+				{
+					std::unique_lock write_guard(current.mutex);
+					++current.value;
+				}
+				else
+				{
+					std::shared_lock read_guard(current.mutex);
+					sum += current.value;
+				}
+			}
+			observed += sum;
+		});
+		bench::report(name, numThreads, numThreads * numAccesses, seconds);
+	}
+}
+
+int main()
+{
+	using namespace mtx;
+	report_footprint<std::shared_mutex>("std::shared_mutex");
+	report_footprint<shared_recursive_mutex>("mtx::shared_recursive_mutex");
+	report_footprint<compact_shared_recursive_mutex>("mtx::compact_shared_recursive_mutex");
+	benchmark_per_object_locks<std::shared_mutex>("std::shared_mutex");
+	benchmark_per_object_locks<shared_recursive_mutex>("mtx::shared_recursive_mutex");
+	benchmark_per_object_locks<compact_shared_recursive_mutex>("mtx::compact_shared_recursive_mutex");
+}
@@ -0,0 +1,74 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include "benchmark.hpp"
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_mutex>
+#include <mutex>
+#include <string>
+
+constexpr unsigned numWriters = 2;
+constexpr uint64_t numWrites = 2000;
+//with reader_preferring the writers can starve, so the readers stop after this time
+constexpr auto maxDuration = std::chrono::seconds(2);
+
+//readers hammer the lock while a few writers write every now and then.
+//shows the read throughput and how long the writers have to wait for the lock with each fairness policy
+template<typename Backend>
+void benchmark_fairness(const std::string& name)
+{
+	auto& mutex = mtx::shared_recursive_mutex_t<struct FairnessType, Backend>::instance();
+	uint64_t value = 0;
+	for (unsigned numReaders : bench::thread_counts())
+	{
+		std::atomic<unsigned> writersDone{ 0 };
+		std::atomic<uint64_t> reads{ 0 };
+		std::atomic<uint64_t> observed{ 0 };
+		const auto deadline = std::chrono::steady_clock::now() + maxDuration;
+		std::vector<std::vector<double>> writerLatencies(numWriters);
+		const double seconds = bench::run_parallel(numReaders + numWriters, [&](unsigned i) {
+			if (i < numWriters)
+			{
+				auto& latencies = writerLatencies[i];
+				latencies.reserve(numWrites);
+				for (uint64_t write = 0; write < numWrites; ++write)
+				{
+					const auto start = std::chrono::steady_clock::now();
+					std::unique_lock write_guard(mutex);
+					latencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+					++value;
+					write_guard.unlock();
+					std::this_thread::sleep_for(std::chrono::microseconds(50));
+				}
+				++writersDone;
+				return;
+			}
+			uint64_t sum = 0;
+			uint64_t numReads = 0;
+			while (writersDone.load(std::memory_order_relaxed) != numWriters && (numReads % 256 != 0 || std::chrono::steady_clock::now() < deadline))
+			{
+				std::shared_lock read_guard(mutex);
+				//re-entry never reaches the backend, so it can't deadlock against a waiting writer
+				std::shared_lock nested_read_guard(mutex);
+				sum += value;
+				++numReads;
+			}
+			reads += numReads;
+			observed += sum;
+		});
+		std::vector<double> latencies;
+		for (auto& writer : writerLatencies)
+			latencies.insert(latencies.end(), writer.begin(), writer.end());
+		bench::report(name + " reads", numReaders, reads.load(), seconds);
+		bench::report_latency(name + " writer wait", numReaders, std::move(latencies));
+	}
+}
+
+int main()
+{
+	using namespace mtx;
+	benchmark_fairness<std::shared_mutex>("std::shared_mutex");
+	benchmark_fairness<basic_shared_futex_mutex<park_wait_policy, lock_fairness::writer_preferring>>("writer_preferring");
+	benchmark_fairness<basic_shared_futex_mutex<park_wait_policy, lock_fairness::reader_preferring>>("reader_preferring");
+	benchmark_fairness<basic_shared_futex_mutex<park_wait_policy, lock_fairness::phase_fair>>("phase_fair");
+}
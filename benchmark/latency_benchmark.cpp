@@ -0,0 +1,70 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include "benchmark.hpp"
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/phase_fair_ticket_mutex.hpp>
+#include <shared_recursive_mutex/queued_shared_mutex.hpp>
+#include <shared_mutex>
+#include <mutex>
+#include <string>
+
+constexpr uint64_t numAcquisitions = 20000;
+constexpr uint64_t writeEvery = 10;
+
+//every thread mixes reads and writes and measures how long each acquisition takes.
+//for latency critical threads the worst case matters, so the maximum and the 99th percentile are reported next to the mean
+template<typename Backend>
+void benchmark_latency(const std::string& name)
+{
+	auto& mutex = mtx::shared_recursive_mutex_t<struct LatencyType, Backend>::instance();
+	uint64_t value = 0;
+	for (unsigned numThreads : bench::thread_counts())
+	{
+		std::vector<std::vector<double>> readerLatencies(numThreads);
+		std::vector<std::vector<double>> writerLatencies(numThreads);
+		std::atomic<uint64_t> observed{ 0 };
+		bench::run_parallel(numThreads, [&](unsigned thread) {
+			auto& readLatencies = readerLatencies[thread];
+			auto& writeLatencies = writerLatencies[thread];
+			readLatencies.reserve(numAcquisitions);
+			writeLatencies.reserve(numAcquisitions / writeEvery);
+			uint64_t sum = 0;
+			for (uint64_t i = 1; i <= numAcquisitions; ++i)
+			{
+				const auto start = std::chrono::steady_clock::now();
+				if (i % writeEvery == 0)
+				{
+					std::unique_lock write_guard(mutex);
+					writeLatencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+					++value;
+				}
+				else
+				{
+					std::shared_lock read_guard(mutex);
+					readLatencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+					sum += value;
+				}
+			}
+			observed += sum;
+		});
+		auto merge = [](std::vector<std::vector<double>>& perThread) {
+			std::vector<double> merged;
+			for (auto& latencies : perThread)
+				merged.insert(merged.end(), latencies.begin(), latencies.end());
+			return merged;
+		};
+		bench::report_latency(name + " reader wait", numThreads, merge(readerLatencies));
+		bench::report_latency(name + " writer wait", numThreads, merge(writerLatencies));
+	}
+}
+
+int main()
+{
+	using namespace mtx;
+	benchmark_latency<std::shared_mutex>("std::shared_mutex");
+	benchmark_latency<shared_futex_mutex>("mtx::shared_futex_mutex");
+	benchmark_latency<basic_shared_futex_mutex<park_wait_policy, lock_fairness::phase_fair>>("phase_fair shared_futex_mutex");
+	benchmark_latency<queued_shared_mutex>("mtx::queued_shared_mutex");
+	benchmark_latency<phase_fair_ticket_mutex>("mtx::phase_fair_ticket_mutex");
+}
@@ -0,0 +1,78 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include "benchmark.hpp"
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/distributed_shared_mutex.hpp>
+#include <shared_recursive_mutex/membarrier_shared_mutex.hpp>
+#include <shared_mutex>
+#include <mutex>
+#include <string>
+
+constexpr uint64_t numIterations = 5000000;
+
+//the cost of reading a value without any synchronization, this is the lower bound for every read path
+void benchmark_plain_load()
+{
+	std::atomic<uint64_t> value{ 42 };
+	for (unsigned numThreads : bench::thread_counts())
+	{
+		std::atomic<uint64_t> observed{ 0 };
+		const double seconds = bench::run_parallel(numThreads, [&](unsigned) {
+			uint64_t sum = 0;
+			for (uint64_t i = 0; i < numIterations; ++i)
+				sum += value.load(std::memory_order_relaxed);
+			observed += sum;
+		});
+		bench::report("uninstrumented load", numThreads, numThreads * numIterations, seconds);
+	}
+}
+
+//read only traffic directly on the backend, optionally with one writer that updates the value every millisecond
+template<typename Mutex>
+void benchmark_read_path(const std::string& name, bool withWriter)
+{
+	Mutex mutex;
+	std::atomic<uint64_t> value{ 42 };
+	for (unsigned numThreads : bench::thread_counts())
+	{
+		std::atomic<uint64_t> observed{ 0 };
+		std::atomic<unsigned> readersDone{ 0 };
+		const double seconds = bench::run_parallel(numThreads + (withWriter ? 1 : 0), [&](unsigned threadIndex) {
+			if (threadIndex == numThreads)
+			{
+				while (readersDone.load() != numThreads)
+				{
+					mutex.lock();
+					value.store(value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+					mutex.unlock();
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+				return;
+			}
+			uint64_t sum = 0;
+			for (uint64_t i = 0; i < numIterations; ++i)
+			{
+				mutex.lock_shared();
+				sum += value.load(std::memory_order_relaxed);
+				mutex.unlock_shared();
+			}
+			observed += sum;
+			++readersDone;
+		});
+		bench::report(name + (withWriter ? " read, 1 writer/ms" : " read only"), numThreads, numThreads * numIterations, seconds);
+	}
+}
+
+int main()
+{
+	std::cout << "membarrier available: " << (mtx::detail::membarrier_available() ? "yes" : "no") << "\n";
+	benchmark_plain_load();
+	for (bool withWriter : { false, true })
+	{
+		benchmark_read_path<std::shared_mutex>("std::shared_mutex", withWriter);
+		benchmark_read_path<mtx::shared_futex_mutex>("mtx::shared_futex_mutex", withWriter);
+		benchmark_read_path<mtx::distributed_shared_mutex<>>("mtx::distributed_shared_mutex", withWriter);
+		benchmark_read_path<mtx::membarrier_shared_mutex>("mtx::membarrier_shared_mutex", withWriter);
+	}
+}
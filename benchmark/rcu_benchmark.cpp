@@ -0,0 +1,135 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include "benchmark.hpp"
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/rcu_protected.hpp>
+#include <array>
+#include <shared_mutex>
+#include <mutex>
+#include <string>
+
+constexpr uint64_t numReads = 2000000;
+constexpr uint64_t numUpdates = 2000;
+
+namespace
+{
+	struct RcuBenchType;
+
+	//retire and reclamation happen in the writer thread while it holds the write lock, so no synchronization is needed
+	std::vector<std::chrono::steady_clock::time_point> g_retiredAt;
+	std::vector<double> g_reclamationLatencies;
+	std::atomic<uint64_t> g_liveVersions{ 0 };
+
+	struct payload
+	{
+		explicit payload(uint64_t versionId) : id(versionId) { ++g_liveVersions; }
+		payload(const payload&) = delete;
+		~payload()
+		{
+			--g_liveVersions;
+			//the current version is deleted by the destructor of the rcu_protected, it was never retired
+			if (id < g_retiredAt.size() && g_retiredAt[id] != std::chrono::steady_clock::time_point{})
+				g_reclamationLatencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - g_retiredAt[id]).count());
+		}
+
+		uint64_t id;
+		std::array<uint64_t, 32> values{};
+	};
+
+	uint64_t read_payload(const payload& value)
+	{
+		uint64_t sum = 0;
+		for (uint64_t v : value.values)
+			sum += v;
+		return sum;
+	}
+}
+
+//readers read continuously while one writer publishes a new version every 10 microseconds.
+//reports the read throughput, how long it takes from retiring a version until it's deleted and the highest number of
+//versions that were alive at the same time (the memory the deferred reclamation costs)
+void benchmark_rcu()
+{
+	for (unsigned numThreads : bench::thread_counts())
+	{
+		g_retiredAt.assign(numUpdates + 1, {});
+		g_reclamationLatencies.clear();
+		uint64_t maxLiveVersions = 0;
+		{
+			mtx::rcu_protected<payload, RcuBenchType> protectedValue(std::make_unique<payload>(numUpdates));
+			std::atomic<uint64_t> observed{ 0 };
+			std::atomic<unsigned> readersDone{ 0 };
+			const double seconds = bench::run_parallel(numThreads + 1, [&](unsigned threadIndex) {
+				if (threadIndex == numThreads)
+				{
+					uint64_t currentId = numUpdates;
+					for (uint64_t id = 0; id < numUpdates && readersDone.load() != numThreads; ++id)
+					{
+						auto next = std::make_unique<payload>(id);
+						next->values.fill(id);
+						g_retiredAt[currentId] = std::chrono::steady_clock::now();
+						protectedValue.update(std::move(next));
+						currentId = id;
+						maxLiveVersions = std::max(maxLiveVersions, g_liveVersions.load());
+						std::this_thread::sleep_for(std::chrono::microseconds(10));
+					}
+					return;
+				}
+				uint64_t sum = 0;
+				for (uint64_t i = 0; i < numReads; ++i)
+					sum += read_payload(*protectedValue.read());
+				observed += sum;
+				++readersDone;
+			});
+			bench::report("rcu_protected read", numThreads, numThreads * numReads, seconds);
+			protectedValue.synchronize();
+		}
+		bench::report_latency("rcu_protected retire until reclaimed", numThreads, g_reclamationLatencies);
+		std::cout << std::left << std::setw(56) << "rcu_protected live versions"
+			<< " threads: " << std::setw(4) << numThreads
+			<< " max: " << maxLiveVersions << " (" << maxLiveVersions * sizeof(payload) << " bytes)"
+			<< " reader records: " << numThreads * sizeof(mtx::detail::thread_registry<mtx::detail::rcu_reader_record<RcuBenchType>>::node) << " bytes\n";
+	}
+}
+
+//the same workload with the readers taking the read lock of the shared_recursive_mutex_t and the writer updating in place
+void benchmark_shared_lock()
+{
+	auto& mutex = mtx::shared_recursive_mutex_t<struct RcuLockType>::instance();
+	for (unsigned numThreads : bench::thread_counts())
+	{
+		payload value(numUpdates + 1);
+		std::atomic<uint64_t> observed{ 0 };
+		std::atomic<unsigned> readersDone{ 0 };
+		const double seconds = bench::run_parallel(numThreads + 1, [&](unsigned threadIndex) {
+			if (threadIndex == numThreads)
+			{
+				for (uint64_t id = 0; id < numUpdates && readersDone.load() != numThreads; ++id)
+				{
+					{
+						std::unique_lock write_guard(mutex);
+						value.values.fill(id);
+					}
+					std::this_thread::sleep_for(std::chrono::microseconds(10));
+				}
+				return;
+			}
+			uint64_t sum = 0;
+			for (uint64_t i = 0; i < numReads; ++i)
+			{
+				std::shared_lock read_guard(mutex);
+				sum += read_payload(value);
+			}
+			observed += sum;
+			++readersDone;
+		});
+		bench::report("shared_recursive_mutex_t read", numThreads, numThreads * numReads, seconds);
+	}
+}
+
+int main()
+{
+	benchmark_rcu();
+	benchmark_shared_lock();
+}
@@ -0,0 +1,41 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include "benchmark.hpp"
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/distributed_shared_mutex.hpp>
+#include <shared_mutex>
+#include <mutex>
+#include <string>
+
+constexpr uint64_t numIterations = 2000000;
+
+//read only traffic through the shared_recursive_mutex_t, the throughput (Mops/s) should grow linearly with the number of cores
+template<typename Backend>
+void benchmark_read_scaling(const std::string& name)
+{
+	auto& mutex = mtx::shared_recursive_mutex_t<struct ReadScalingType, Backend>::instance();
+	uint64_t value = 42;
+	for (unsigned numThreads : bench::thread_counts())
+	{
+		std::atomic<uint64_t> observed{ 0 };
+		const double seconds = bench::run_parallel(numThreads, [&](unsigned) {
+			uint64_t sum = 0;
+			for (uint64_t i = 0; i < numIterations; ++i)
+			{
+				std::shared_lock read_guard(mutex);
+				sum += value;
+			}
+			observed += sum;
+		});
+		bench::report(name + " read only", numThreads, numThreads * numIterations, seconds);
+	}
+}
+
+int main()
+{
+	benchmark_read_scaling<std::shared_mutex>("std::shared_mutex");
+	benchmark_read_scaling<mtx::shared_futex_mutex>("mtx::shared_futex_mutex");
+	benchmark_read_scaling<mtx::distributed_shared_mutex<>>("mtx::distributed_shared_mutex");
+	benchmark_read_scaling<mtx::distributed_shared_mutex<mtx::percpu_reader_indicator>>("mtx::distributed_shared_mutex<percpu>");
+}
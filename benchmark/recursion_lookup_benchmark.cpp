@@ -0,0 +1,42 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include "benchmark.hpp"
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_mutex>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+
+constexpr uint64_t numIterations = 2000000;
+
+//cost of finding the thread local recursion counters: static thread local counters (PhantomType) versus the address keyed table
+template<typename Mutex>
+void benchmark_nested_read(const std::string& name, std::vector<Mutex*> mutexes)
+{
+	const double seconds = bench::run_parallel(1, [&](unsigned) {
+		for (uint64_t i = 0; i < numIterations; ++i)
+		{
+			auto& mutex = *mutexes[i % mutexes.size()];
+			std::shared_lock read_guard(mutex);
+			std::shared_lock nested_read_guard(mutex);
+		}
+	});
+	bench::report(name, 1, numIterations, seconds);
+}
+
+int main()
+{
+	auto& phantomMutex = mtx::shared_recursive_mutex_t<struct LookupBenchmarkType>::instance();
+	benchmark_nested_read("shared_recursive_mutex_t (PhantomType)", std::vector{ &phantomMutex });
+
+	for (std::size_t numMutexes : { 1, 2, 8, 1000 })
+	{
+		std::vector<std::unique_ptr<mtx::shared_recursive_mutex>> storage;
+		std::vector<mtx::shared_recursive_mutex*> mutexes;
+		for (std::size_t i = 0; i < numMutexes; ++i)
+			mutexes.push_back(storage.emplace_back(std::make_unique<mtx::shared_recursive_mutex>()).get());
+		benchmark_nested_read("shared_recursive_mutex (" + std::to_string(numMutexes) + " mutexes round robin)", mutexes);
+	}
+}
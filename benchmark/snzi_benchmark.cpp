@@ -0,0 +1,62 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include "benchmark.hpp"
+#include <shared_recursive_mutex/distributed_shared_mutex.hpp>
+#include <shared_recursive_mutex/reader_indicator.hpp>
+#include <shared_mutex>
+#include <mutex>
+#include <string>
+
+constexpr uint64_t numIterations = 200000;
+
+//a single shared reader count, like the one inside of std::shared_mutex
+class flat_reader_indicator {
+public:
+	void arrive() { m_readers.fetch_add(1, std::memory_order_seq_cst); }
+	void depart() { m_readers.fetch_sub(1, std::memory_order_release); }
+	[[nodiscard]] bool empty() const { return m_readers.load(std::memory_order_seq_cst) == 0; }
+
+private:
+	std::atomic<uint32_t> m_readers{ 0 };
+};
+
+//read only traffic through a distributed_shared_mutex with the given reader indicator, the write ratio is 1 in writeEvery
+template<typename ReaderIndicator>
+void benchmark_indicator(const std::string& name, uint64_t writeEvery)
+{
+	for (unsigned numThreads : { 8u, 32u, 128u })
+	{
+		mtx::distributed_shared_mutex<ReaderIndicator> mutex;
+		uint64_t value = 0;
+		std::atomic<uint64_t> observed{ 0 };
+		const double seconds = bench::run_parallel(numThreads, [&](unsigned) {
+			uint64_t sum = 0;
+			for (uint64_t i = 1; i <= numIterations; ++i)
+			{
+				if (writeEvery != 0 && i % writeEvery == 0)
+				{
+					std::unique_lock write_guard(mutex);
+					++value;
+				}
+				else
+				{
+					std::shared_lock read_guard(mutex);
+					sum += value;
+				}
+			}
+			observed += sum;
+		});
+		bench::report(name + (writeEvery != 0 ? " 1/" + std::to_string(writeEvery) + " writes" : " read only"), numThreads, numThreads * numIterations, seconds);
+	}
+}
+
+int main()
+{
+	for (uint64_t writeEvery : { uint64_t{ 0 }, uint64_t{ 1000 } })
+	{
+		benchmark_indicator<flat_reader_indicator>("flat counter", writeEvery);
+		benchmark_indicator<mtx::slotted_reader_indicator<>>("mtx::slotted_reader_indicator", writeEvery);
+		benchmark_indicator<mtx::snzi_reader_indicator<>>("mtx::snzi_reader_indicator", writeEvery);
+	}
+}
@@ -0,0 +1,55 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include "benchmark.hpp"
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/shared_spin_mutex.hpp>
+#include <shared_mutex>
+#include <mutex>
+#include <array>
+#include <string>
+
+constexpr uint64_t numIterations = 1000000;
+
+//critical sections of a few nanoseconds (a handful of loads and stores), as they are typical for market data handlers.
+//the spin lock only makes sense with at most one thread per core, so the thread counts stop at the hardware concurrency
+template<typename Mutex>
+void benchmark_short_sections(const std::string& name, uint64_t writeEvery)
+{
+	auto& mutex = Mutex::instance();
+	const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	std::array<uint64_t, 4> values{};
+	for (unsigned numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+	{
+		std::atomic<uint64_t> observed{ 0 };
+		const double seconds = bench::run_parallel(numThreads, [&](unsigned) {
+			uint64_t sum = 0;
+			for (uint64_t i = 1; i <= numIterations; ++i)
+			{
+				if (i % writeEvery == 0)
+				{
+					std::unique_lock write_guard(mutex);
+					for (auto& value : values)
+						++value;
+				}
+				else
+				{
+					std::shared_lock read_guard(mutex);
+					for (auto value : values)
+						sum += value;
+				}
+			}
+			observed += sum;
+		});
+		bench::report(name + " 1/" + std::to_string(writeEvery) + " writes", numThreads, numThreads * numIterations, seconds);
+	}
+}
+
+int main()
+{
+	for (uint64_t writeEvery : { uint64_t{ 100 }, uint64_t{ 10 }, uint64_t{ 2 } })
+	{
+		benchmark_short_sections<mtx::shared_recursive_mutex_t<struct FutexType>>("mtx::shared_futex_mutex", writeEvery);
+		benchmark_short_sections<mtx::shared_recursive_spin_mutex_t<struct SpinType>>("mtx::shared_spin_mutex", writeEvery);
+	}
+}
@@ -0,0 +1,211 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/shared_futex_mutex.hpp>
+#include <shared_recursive_mutex/detail/spin.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace mtx
+{
+    namespace detail
+    {
+        /**
+        * @brief Global table of readers that hold a bravo_shared_mutex without touching its backend, shared by all bravo mutexes.
+        */
+        //a slot contains the address of the mutex that is read locked through it, the slot of a reader is a hash of the
+        //thread and the mutex, so different threads (and different mutexes of one thread) spread over the table.
+        //a reader that finds its slot occupied simply takes the slow path through the backend.
+        class visible_readers {
+        public:
+            //4096 slots of 8 bytes, large enough to make collisions rare, small enough for a writer to scan
+            static constexpr std::size_t TABLE_SIZE = 4096;
+
+            static std::atomic<const void*>& slot(const void* mutex) { return g_table[index(mutex)]; }
+            /**
+            * @brief Waits until no reader holds the mutex through the table.
+            */
+            static void drain(const void* mutex)
+            {
+                for (auto& slot : g_table)
+                {
+                    detail::backoff<> backoff;
+                    while (slot.load(std::memory_order_seq_cst) == mutex)
+                        backoff.pause();
+                }
+            }
+            /**
+            * @brief Returns true if a reader holds the mutex through the table.
+            */
+            [[nodiscard]] static bool any(const void* mutex)
+            {
+                return std::any_of(g_table.begin(), g_table.end(), [mutex](const auto& slot) { return slot.load(std::memory_order_seq_cst) == mutex; });
+            }
+
+            //the slot of a reader could also contain the same mutex because another thread with the same hash took the slow path,
+            //so every thread marks the slots it took. A marked slot that contains the mutex is ours: if we had taken it for another
+            //mutex with the same hash, it would still contain that one. Neither allocates nor throws, so the fast path can't leak a slot
+            static void remember(const void* mutex) noexcept { g_held[index(mutex)] = true; }
+            static bool forget(const void* mutex) noexcept
+            {
+                const std::size_t current = index(mutex);
+                if (!g_held[current] || g_table[current].load(std::memory_order_relaxed) != mutex)
+                    return false;
+                g_held[current] = false;
+                return true;
+            }
+
+        private:
+            static std::size_t index(const void* mutex) noexcept
+            {
+                static thread_local const char g_threadTag = 0;
+                const auto address = static_cast<uint64_t>(reinterpret_cast<std::uintptr_t>(mutex) ^ (reinterpret_cast<std::uintptr_t>(&g_threadTag) << 16));
+                //fibonacci hashing, TABLE_SIZE is 2^12
+                return static_cast<std::size_t>((address * 0x9E3779B97F4A7C15ull) >> 52);
+            }
+
+            static inline std::array<std::atomic<const void*>, TABLE_SIZE> g_table{};
+            //one bit per slot of the table, 512 bytes per thread
+            static inline thread_local std::bitset<TABLE_SIZE> g_held;
+        };
+    }
+
+    /**
+    * @brief BRAVO reader bias for a Backend: while the mutex is read biased, readers only publish themselves in a global table.
+    */
+    //biased readers never write to the mutex itself, so read mostly workloads don't bounce the cache line of the backend.
+    //a writer first locks the backend, which keeps new readers on the slow path, then revokes the bias and waits until the
+    //table has no reader of this mutex anymore. Revocation scans the whole table, so afterwards the bias stays disabled for
+    //InhibitFactor times the time the revocation took. The first reader on the slow path after that enables it again.
+    //the recursion layer only calls the backend for the outermost lock of a thread, so the recursion semantics don't change.
+    template<typename Backend = shared_futex_mutex, uint32_t InhibitFactor = 9>
+    class bravo_shared_mutex {
+    public:
+        bravo_shared_mutex() = default;
+        /**
+        * @brief Copying the mutex is not allowed
+        */
+        bravo_shared_mutex(const bravo_shared_mutex&) = delete;
+        bravo_shared_mutex& operator =(const bravo_shared_mutex&) = delete;
+
+        void lock();
+        void lock_shared();
+        void unlock();
+        void unlock_shared();
+        [[nodiscard]] bool try_lock();
+        [[nodiscard]] bool try_lock_shared();
+
+        /**
+        * @brief Returns true if readers currently bypass the backend.
+        */
+        [[nodiscard]] bool is_read_biased() const { return m_readBias.load(std::memory_order_relaxed); }
+
+    private:
+        bool try_lock_biased();
+        void enable_bias();
+
+        Backend m_backend;
+        //read by every reader, but only written when the bias changes
+        std::atomic<bool> m_readBias{ true };
+        std::atomic<std::chrono::steady_clock::rep> m_inhibitUntil{ 0 };
+    };
+
+    template<typename Backend, uint32_t InhibitFactor>
+    void bravo_shared_mutex<Backend, InhibitFactor>::lock()
+    {
+        m_backend.lock();
+        if (!m_readBias.load(std::memory_order_relaxed))
+            return;
+        const auto start = std::chrono::steady_clock::now();
+        //readers publish their slot first and then check the bias, so after this store every reader is either visible or takes the slow path
+        m_readBias.store(false, std::memory_order_seq_cst);
+        detail::visible_readers::drain(this);
+        const auto now = std::chrono::steady_clock::now();
+        m_inhibitUntil.store((now + (now - start) * InhibitFactor).time_since_epoch().count(), std::memory_order_relaxed);
+    }
+    template<typename Backend, uint32_t InhibitFactor>
+    void bravo_shared_mutex<Backend, InhibitFactor>::lock_shared()
+    {
+        if (try_lock_biased())
+            return;
+        m_backend.lock_shared();
+        enable_bias();
+    }
+    template<typename Backend, uint32_t InhibitFactor>
+    void bravo_shared_mutex<Backend, InhibitFactor>::unlock()
+    {
+        m_backend.unlock();
+    }
+    template<typename Backend, uint32_t InhibitFactor>
+    void bravo_shared_mutex<Backend, InhibitFactor>::unlock_shared()
+    {
+        if (detail::visible_readers::forget(this))
+            detail::visible_readers::slot(this).store(nullptr, std::memory_order_release);
+        else
+            m_backend.unlock_shared();
+    }
+    template<typename Backend, uint32_t InhibitFactor>
+    bool bravo_shared_mutex<Backend, InhibitFactor>::try_lock()
+    {
+        if (!m_backend.try_lock())
+            return false;
+        if (!m_readBias.load(std::memory_order_relaxed))
+            return true;
+        m_readBias.store(false, std::memory_order_seq_cst);
+        if (!detail::visible_readers::any(this))
+            return true;
+        //the biased readers stay, so we just give the bias back
+        m_readBias.store(true, std::memory_order_relaxed);
+        m_backend.unlock();
+        return false;
+    }
+    template<typename Backend, uint32_t InhibitFactor>
+    bool bravo_shared_mutex<Backend, InhibitFactor>::try_lock_shared()
+    {
+        if (try_lock_biased())
+            return true;
+        if (!m_backend.try_lock_shared())
+            return false;
+        enable_bias();
+        return true;
+    }
+    template<typename Backend, uint32_t InhibitFactor>
+    bool bravo_shared_mutex<Backend, InhibitFactor>::try_lock_biased()
+    {
+        if (!m_readBias.load(std::memory_order_acquire))
+            return false;
+        auto& slot = detail::visible_readers::slot(this);
+        const void* expected = nullptr;
+        if (!slot.compare_exchange_strong(expected, this, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return false;
+        //a writer might have revoked the bias in between, it might not have seen our slot
+        if (m_readBias.load(std::memory_order_seq_cst))
+        {
+            detail::visible_readers::remember(this);
+            return true;
+        }
+        slot.store(nullptr, std::memory_order_release);
+        return false;
+    }
+    template<typename Backend, uint32_t InhibitFactor>
+    void bravo_shared_mutex<Backend, InhibitFactor>::enable_bias()
+    {
+        //we hold the backend in shared mode, so no writer can revoke the bias at the same time
+        if (!m_readBias.load(std::memory_order_relaxed)
+            && std::chrono::steady_clock::now().time_since_epoch().count() >= m_inhibitUntil.load(std::memory_order_relaxed))
+            m_readBias.store(true, std::memory_order_release);
+    }
+
+    /**
+    * @brief shared_recursive_mutex_t variant with BRAVO reader bias on top of the shared_futex_mutex
+    */
+    template<typename PhantomType>
+    using shared_recursive_bravo_mutex_t = shared_recursive_mutex_t<PhantomType, bravo_shared_mutex<>>;
+}
@@ -0,0 +1,150 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/distributed_shared_mutex.hpp>
+#include <shared_recursive_mutex/reader_indicator.hpp>
+#include <shared_recursive_mutex/wait_policy.hpp>
+#include <shared_recursive_mutex/detail/cache_line.hpp>
+#include <shared_recursive_mutex/detail/futex.hpp>
+#include <shared_recursive_mutex/detail/numa.hpp>
+#include <shared_recursive_mutex/detail/spin.hpp>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace mtx
+{
+    /**
+    * @brief NUMA aware reader/writer lock (cohort lock): writers hand the lock to waiting writers of the same node before it goes to another node.
+    */
+    //every node has a local ticket lock, a writer first gets the lock of its node and then the global lock (a big reader lock with one reader counter per node).
+    //when a writer unlocks and another writer of the same node waits, it only hands over the local lock and keeps the global lock for the cohort,
+    //so the protected data stays in the caches of the node. After BatchBound handovers in a row the global lock is released, so the other
+    //nodes (and the readers) can't be starved.
+    //readers only use the global lock, so they are aggregated per node as well.
+    template<std::size_t MaxNodes = 8, uint32_t BatchBound = 64>
+    class cohort_shared_mutex {
+    public:
+        static_assert(BatchBound > 0, "the batch bound has to be at least 1");
+
+        cohort_shared_mutex() = default;
+        /**
+        * @brief Copying the mutex is not allowed
+        */
+        cohort_shared_mutex(const cohort_shared_mutex&) = delete;
+        cohort_shared_mutex& operator =(const cohort_shared_mutex&) = delete;
+
+        void lock();
+        void lock_shared() { m_global.lock_shared(); }
+        void unlock();
+        void unlock_shared() { m_global.unlock_shared(); }
+        [[nodiscard]] bool try_lock();
+        [[nodiscard]] bool try_lock_shared() { return m_global.try_lock_shared(); }
+
+    private:
+        struct alignas(detail::cache_line_size) node_lock
+        {
+            std::atomic<uint32_t> m_next{ 0 };
+            std::atomic<uint32_t> m_serving{ 0 };
+            //only accessed by the owner of the node lock
+            bool m_globalOwned = false;
+            uint32_t m_batch = 0;
+
+            void lock();
+            bool try_lock();
+            void unlock();
+            bool has_waiters() const { return m_next.load(std::memory_order_relaxed) - m_serving.load(std::memory_order_relaxed) > 1; }
+        };
+
+        //a thread always uses the lock of its home node, so lock and unlock find the same one even if the thread migrated in between
+        node_lock& this_node() { return m_nodes[detail::this_thread_numa_node() % MaxNodes]; }
+
+        std::array<node_lock, MaxNodes> m_nodes;
+        distributed_shared_mutex<numa_reader_indicator<MaxNodes>> m_global;
+    };
+
+    template<std::size_t MaxNodes, uint32_t BatchBound>
+    void cohort_shared_mutex<MaxNodes, BatchBound>::lock()
+    {
+        auto& node = this_node();
+        node.lock();
+        //the previous owner of the node lock might have passed the global lock on to us
+        if (!node.m_globalOwned)
+        {
+            m_global.lock();
+            node.m_globalOwned = true;
+        }
+    }
+    template<std::size_t MaxNodes, uint32_t BatchBound>
+    void cohort_shared_mutex<MaxNodes, BatchBound>::unlock()
+    {
+        auto& node = this_node();
+        if (node.has_waiters() && ++node.m_batch < BatchBound)
+        {
+            //the next writer of this node gets the global lock with the node lock
+            node.unlock();
+            return;
+        }
+        node.m_batch = 0;
+        node.m_globalOwned = false;
+        m_global.unlock();
+        node.unlock();
+    }
+    template<std::size_t MaxNodes, uint32_t BatchBound>
+    bool cohort_shared_mutex<MaxNodes, BatchBound>::try_lock()
+    {
+        auto& node = this_node();
+        if (!node.try_lock())
+            return false;
+        //a free node lock was not handed over, so the global lock is not owned by the node
+        if (m_global.try_lock())
+        {
+            node.m_globalOwned = true;
+            return true;
+        }
+        node.unlock();
+        return false;
+    }
+    template<std::size_t MaxNodes, uint32_t BatchBound>
+    void cohort_shared_mutex<MaxNodes, BatchBound>::node_lock::lock()
+    {
+        //the ticket and the serving counter are seq_cst on both sides: either unlock sees our ticket and wakes us up
+        //or we see its new serving number, with weaker orders both could read the old value and we would never wake up
+        const uint32_t ticket = m_next.fetch_add(1, std::memory_order_seq_cst);
+        detail::backoff<> backoff;
+        for (;;)
+        {
+            const uint32_t serving = m_serving.load(std::memory_order_seq_cst);
+            if (serving == ticket)
+                return;
+            if (detail::max_spinners() > 0 && backoff.spinning())
+                backoff.pause();
+            else
+                detail::futex_wait(m_serving, serving);
+        }
+    }
+    template<std::size_t MaxNodes, uint32_t BatchBound>
+    bool cohort_shared_mutex<MaxNodes, BatchBound>::node_lock::try_lock()
+    {
+        //the lock is free if the next ticket is the one that is served
+        const uint32_t serving = m_serving.load(std::memory_order_acquire);
+        uint32_t next = serving;
+        return m_next.compare_exchange_strong(next, serving + 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+    template<std::size_t MaxNodes, uint32_t BatchBound>
+    void cohort_shared_mutex<MaxNodes, BatchBound>::node_lock::unlock()
+    {
+        const uint32_t serving = m_serving.fetch_add(1, std::memory_order_seq_cst) + 1;
+        if (m_next.load(std::memory_order_seq_cst) != serving)
+            detail::futex_wake_all(m_serving);
+    }
+
+    /**
+    * @brief shared_recursive_mutex_t variant that keeps the write ownership on one NUMA node for up to 64 writers in a row
+    */
+    template<typename PhantomType>
+    using shared_recursive_cohort_mutex_t = shared_recursive_mutex_t<PhantomType, cohort_shared_mutex<>>;
+}
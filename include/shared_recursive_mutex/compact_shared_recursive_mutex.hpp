@@ -0,0 +1,32 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/shared_futex_mutex.hpp>
+
+namespace mtx
+{
+    /**
+    * @brief Shared recursive mutex that is exactly as large as its Backend, e.g. 4 bytes with the shared_futex_mutex, for one lock per object.
+    */
+    //the whole shared state is the 32 bit state word of the backend. The recursion counters of a thread live in the thread local table
+    //that is keyed by the address of the mutex (like for the basic_shared_recursive_mutex) and contended threads park in an external
+    //table keyed by the address of the state word: the futex hash table of the kernel on linux, a global table of condition variables
+    //on other platforms. So a mutex that nobody uses only costs its state word.
+    //there is no room for the queues of combine and defer_write, they are not available.
+    template<typename Backend = shared_futex_mutex>
+    class basic_compact_shared_recursive_mutex : public detail::shared_recursive_mutex_base<basic_compact_shared_recursive_mutex<Backend>, Backend> {
+    public:
+        basic_compact_shared_recursive_mutex() = default;
+
+    private:
+        friend class detail::shared_recursive_mutex_base<basic_compact_shared_recursive_mutex, Backend>;
+
+        static constexpr bool WRITE_QUEUES = false;
+        detail::recursion_counters& thread_counters() const { return detail::recursion_table::find(this); }
+    };
+
+    using compact_shared_recursive_mutex = basic_compact_shared_recursive_mutex<>;
+    static_assert(sizeof(compact_shared_recursive_mutex) == sizeof(uint32_t), "the compact_shared_recursive_mutex has to fit into its 32 bit state word");
+}
@@ -0,0 +1,64 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace mtx
+{
+    /**
+    * @brief Background thread that runs the writes queued with defer_write periodically, so they don't have to wait for the next writer.
+    */
+    //the thread only takes the write ownership if writes are queued. The queue is drained once more when the drainer is destroyed.
+    //works with every mutex that has a drain_deferred_writes member (the shared recursive mutexes).
+    template<typename Mutex>
+    class deferred_write_drainer {
+    public:
+        explicit deferred_write_drainer(Mutex& mutex, std::chrono::microseconds interval = std::chrono::milliseconds(1))
+            : m_mutex(mutex)
+            , m_interval(interval)
+            , m_thread([this]() { run(); })
+        {
+        }
+        ~deferred_write_drainer()
+        {
+            {
+                std::lock_guard lock(m_stopMutex);
+                m_stop = true;
+            }
+            m_stopRequested.notify_one();
+            m_thread.join();
+        }
+        /**
+        * @brief Copying the drainer is not allowed
+        */
+        deferred_write_drainer(const deferred_write_drainer&) = delete;
+        deferred_write_drainer& operator =(const deferred_write_drainer&) = delete;
+
+    private:
+        void run()
+        {
+            std::unique_lock lock(m_stopMutex);
+            for (;;)
+            {
+                const bool stop = m_stopRequested.wait_for(lock, m_interval, [this]() { return m_stop; });
+                lock.unlock();
+                m_mutex.drain_deferred_writes();
+                if (stop)
+                    return;
+                lock.lock();
+            }
+        }
+
+        Mutex& m_mutex;
+        const std::chrono::microseconds m_interval;
+        std::mutex m_stopMutex;
+        std::condition_variable m_stopRequested;
+        bool m_stop = false;
+        //the last member, the thread must not start before the others are initialized
+        std::thread m_thread;
+    };
+}
@@ -0,0 +1,136 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/detail/spin.hpp>
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_jthread)
+#include <stop_token>
+#endif
+
+namespace mtx::detail
+{
+    //the shared_recursive_mutex_t only requires the backend to be SharedLockable,
+    //the optional operations of a backend are detected with these traits
+
+    template<typename Backend, typename = void>
+    struct supports_upgrade : std::false_type {};
+    template<typename Backend>
+    struct supports_upgrade<Backend, std::void_t<
+        decltype(std::declval<Backend&>().lock_upgrade()),
+        decltype(std::declval<Backend&>().unlock_upgrade()),
+        decltype(std::declval<Backend&>().try_lock_upgrade()),
+        decltype(std::declval<Backend&>().unlock_upgrade_and_lock()),
+        decltype(std::declval<Backend&>().try_unlock_upgrade_and_lock()),
+        decltype(std::declval<Backend&>().unlock_and_lock_upgrade()),
+        decltype(std::declval<Backend&>().unlock_upgrade_and_lock_shared())>> : std::true_type {};
+    /**
+    * @brief True if the backend supports upgradeable ownership (lock_upgrade, unlock_upgrade_and_lock, ...)
+    */
+    template<typename Backend>
+    inline constexpr bool supports_upgrade_v = supports_upgrade<Backend>::value;
+
+    template<typename Backend, typename = void>
+    struct supports_shared_promotion : std::false_type {};
+    template<typename Backend>
+    struct supports_shared_promotion<Backend, std::void_t<
+        decltype(std::declval<Backend&>().try_unlock_shared_and_lock())>> : std::true_type {};
+    /**
+    * @brief True if the backend can promote shared ownership to exclusive ownership without releasing it (try_unlock_shared_and_lock)
+    */
+    template<typename Backend>
+    inline constexpr bool supports_shared_promotion_v = supports_shared_promotion<Backend>::value;
+
+    template<typename Backend, typename = void>
+    struct supports_downgrade : std::false_type {};
+    template<typename Backend>
+    struct supports_downgrade<Backend, std::void_t<
+        decltype(std::declval<Backend&>().unlock_and_lock_shared())>> : std::true_type {};
+    /**
+    * @brief True if the backend can atomically demote exclusive ownership to shared ownership (unlock_and_lock_shared)
+    */
+    template<typename Backend>
+    inline constexpr bool supports_downgrade_v = supports_downgrade<Backend>::value;
+
+    template<typename Backend, typename = void>
+    struct supports_timed_lock : std::false_type {};
+    template<typename Backend>
+    struct supports_timed_lock<Backend, std::void_t<
+        decltype(std::declval<Backend&>().try_lock_until(std::declval<const std::chrono::steady_clock::time_point&>())),
+        decltype(std::declval<Backend&>().try_lock_shared_until(std::declval<const std::chrono::steady_clock::time_point&>()))>> : std::true_type {};
+    /**
+    * @brief True if the backend models SharedTimedMutex (try_lock_until, try_lock_shared_until)
+    */
+    template<typename Backend>
+    inline constexpr bool supports_timed_lock_v = supports_timed_lock<Backend>::value;
+
+    template<typename Backend, typename = void>
+    struct supports_timed_upgrade : std::false_type {};
+    template<typename Backend>
+    struct supports_timed_upgrade<Backend, std::void_t<
+        decltype(std::declval<Backend&>().try_unlock_upgrade_and_lock_until(std::declval<const std::chrono::steady_clock::time_point&>()))>> : std::true_type {};
+    /**
+    * @brief True if the backend can wait for the promotion of upgradeable ownership with a deadline (try_unlock_upgrade_and_lock_until)
+    */
+    template<typename Backend>
+    inline constexpr bool supports_timed_upgrade_v = supports_timed_upgrade<Backend>::value;
+
+    template<typename Backend, typename = void>
+    struct supports_optimistic_read : std::false_type {};
+    template<typename Backend>
+    struct supports_optimistic_read<Backend, std::void_t<
+        decltype(std::declval<const Backend&>().read_begin()),
+        decltype(std::declval<const Backend&>().read_validate(std::declval<uint64_t>())),
+        decltype(Backend::max_failed_validations)>> : std::true_type {};
+    /**
+    * @brief True if readers can read without taking the lock and validate afterwards that no writer interfered (read_begin, read_validate)
+    */
+    template<typename Backend>
+    inline constexpr bool supports_optimistic_read_v = supports_optimistic_read<Backend>::value;
+
+    template<typename Backend, typename = void>
+    struct never_enters_kernel : std::false_type {};
+    template<typename Backend>
+    struct never_enters_kernel<Backend, std::enable_if_t<Backend::never_enters_kernel>> : std::true_type {};
+    /**
+    * @brief True if the backend promises to never yield or park (Backend::never_enters_kernel), the recursion layer must not do it either
+    */
+    template<typename Backend>
+    inline constexpr bool never_enters_kernel_v = never_enters_kernel<Backend>::value;
+    /**
+    * @brief The backoff the recursion layer uses when it polls the backend, it only yields if the backend may enter the kernel anyway
+    */
+    template<typename Backend>
+    using backoff_for = std::conditional_t<never_enters_kernel_v<Backend>, spin_backoff<>, backoff<>>;
+
+#if defined(__cpp_lib_jthread)
+    template<typename Backend, typename = void>
+    struct supports_stop_token : std::false_type {};
+    template<typename Backend>
+    struct supports_stop_token<Backend, std::void_t<
+        decltype(std::declval<Backend&>().lock(std::declval<std::stop_token>())),
+        decltype(std::declval<Backend&>().lock_shared(std::declval<std::stop_token>()))>> : std::true_type {};
+    /**
+    * @brief True if the backend can give up waiting for the lock when a stop is requested (lock(std::stop_token), lock_shared(std::stop_token))
+    */
+    template<typename Backend>
+    inline constexpr bool supports_stop_token_v = supports_stop_token<Backend>::value;
+
+    template<typename Backend, typename = void>
+    struct supports_stoppable_upgrade : std::false_type {};
+    template<typename Backend>
+    struct supports_stoppable_upgrade<Backend, std::void_t<
+        decltype(std::declval<Backend&>().unlock_upgrade_and_lock(std::declval<std::stop_token>()))>> : std::true_type {};
+    /**
+    * @brief True if the backend can give up waiting for the promotion of upgradeable ownership when a stop is requested (unlock_upgrade_and_lock(std::stop_token))
+    */
+    template<typename Backend>
+    inline constexpr bool supports_stoppable_upgrade_v = supports_stoppable_upgrade<Backend>::value;
+#endif
+}
@@ -0,0 +1,20 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <cstddef>
+
+namespace mtx::detail
+{
+    //std::hardware_destructive_interference_size is not available everywhere and it's value is not stable across compiler flags
+    inline constexpr std::size_t cache_line_size = 64;
+
+    /**
+    * @brief Gives the value its own cache line, so that writes to it don't invalidate the neighbouring values.
+    */
+    template<typename T>
+    struct alignas(cache_line_size) cache_line_padded
+    {
+        T value;
+    };
+}
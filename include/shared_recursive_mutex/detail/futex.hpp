@@ -0,0 +1,115 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#endif
+
+namespace mtx::detail
+{
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "the futex word has to be a plain 32 bit integer");
+
+    /**
+    * @brief Converts a deadline of any clock to a deadline of the steady_clock, which is the clock futex_wait_until uses.
+    */
+    template<typename Clock, typename Duration>
+    std::chrono::steady_clock::time_point to_steady_deadline(const std::chrono::time_point<Clock, Duration>& deadline)
+    {
+        if constexpr (std::is_same_v<Clock, std::chrono::steady_clock>)
+            return std::chrono::ceil<std::chrono::steady_clock::duration>(deadline);
+        else
+            return std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::steady_clock::duration>(deadline - Clock::now());
+    }
+
+#if defined(__linux__)
+    /**
+    * @brief Parks the calling thread as long as the word contains the expected value.
+    *        Spurious wakeups are possible, so the caller always has to re-check its condition.
+    */
+    inline void futex_wait(std::atomic<uint32_t>& word, uint32_t expected)
+    {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+    }
+
+    /**
+    * @brief Same as futex_wait, but returns false without parking (any longer) once the deadline has passed.
+    */
+    inline bool futex_wait_until(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::steady_clock::time_point deadline)
+    {
+        const auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero())
+            return false;
+        //FUTEX_WAIT takes a relative timeout that is measured against CLOCK_MONOTONIC, like the steady_clock
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+        timespec timeout{};
+        timeout.tv_sec = static_cast<time_t>(seconds.count());
+        timeout.tv_nsec = static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining - seconds).count());
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, &timeout, nullptr, 0);
+        return true;
+    }
+
+    /**
+    * @brief Wakes all threads that are parked on the word.
+    */
+    inline void futex_wake_all(std::atomic<uint32_t>& word)
+    {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+    }
+#else
+    //without a futex we park the waiters in a small global table of condition variables, which is keyed by the address of the word
+    struct parking_bucket
+    {
+        std::mutex m_mtx;
+        std::condition_variable m_cv;
+    };
+
+    inline parking_bucket& parking_bucket_for(const void* address)
+    {
+        static parking_bucket buckets[64];
+        return buckets[(reinterpret_cast<std::uintptr_t>(address) / alignof(std::max_align_t)) % 64];
+    }
+
+    inline void futex_wait(std::atomic<uint32_t>& word, uint32_t expected)
+    {
+        auto& bucket = parking_bucket_for(&word);
+        std::unique_lock lock(bucket.m_mtx);
+        if (word.load(std::memory_order_relaxed) == expected)
+            bucket.m_cv.wait(lock);
+    }
+
+    inline bool futex_wait_until(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::steady_clock::time_point deadline)
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        auto& bucket = parking_bucket_for(&word);
+        std::unique_lock lock(bucket.m_mtx);
+        if (word.load(std::memory_order_relaxed) == expected)
+            bucket.m_cv.wait_until(lock, deadline);
+        return true;
+    }
+
+    inline void futex_wake_all(std::atomic<uint32_t>& word)
+    {
+        auto& bucket = parking_bucket_for(&word);
+        //taking the bucket lock orders us with a waiter that has checked the word but is not yet waiting on the condition variable
+        {
+            std::lock_guard lock(bucket.m_mtx);
+        }
+        bucket.m_cv.notify_all();
+    }
+#endif
+}
@@ -0,0 +1,65 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <atomic>
+
+#if defined(__linux__) && __has_include(<linux/membarrier.h>)
+#include <cerrno>
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define SHARED_RECURSIVE_MUTEX_HAS_MEMBARRIER 1
+#endif
+
+namespace mtx::detail
+{
+    /**
+    * @brief True if this process can use expedited private membarriers, the first call registers the process for them.
+    */
+    inline bool membarrier_available()
+    {
+        static const bool available = []() {
+#if defined(SHARED_RECURSIVE_MUTEX_HAS_MEMBARRIER) && defined(SYS_membarrier)
+            const long commands = syscall(SYS_membarrier, MEMBARRIER_CMD_QUERY, 0);
+            return commands >= 0 && (commands & MEMBARRIER_CMD_PRIVATE_EXPEDITED) != 0
+                && syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+#else
+            return false;
+#endif
+        }();
+        return available;
+    }
+
+    /**
+    * @brief The cheap side of an asymmetric fence, only keeps the compiler from reordering if heavy_fence can use membarriers.
+    */
+    inline void light_fence()
+    {
+        if (membarrier_available())
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        else
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    /**
+    * @brief The expensive side of an asymmetric fence, acts as a full fence on every running thread of the process.
+    */
+    //pairs with light_fence: either the memory accesses before a light_fence are visible after the heavy_fence,
+    //or the accesses after the light_fence see everything before the heavy_fence
+    inline void heavy_fence()
+    {
+#if defined(SHARED_RECURSIVE_MUTEX_HAS_MEMBARRIER) && defined(SYS_membarrier)
+        if (membarrier_available())
+        {
+            //the light_fences are only compiler barriers now, so a fence on this thread alone would not be enough.
+            //the process is registered, the command can't fail for any other reason than an interruption
+            while (syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0) != 0 && errno == EINTR)
+            {
+            }
+            return;
+        }
+#endif
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
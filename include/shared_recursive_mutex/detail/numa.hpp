@@ -0,0 +1,81 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if defined(__linux__)
+#include <fstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace mtx::detail
+{
+    /**
+    * @brief Returns the highest id + 1 of a sysfs cpu/node list like "0-3,8-11", 0 if the list is empty or malformed.
+    */
+    inline std::size_t parse_id_list(const std::string& list)
+    {
+        std::size_t count = 0;
+        std::size_t i = 0;
+        while (i < list.size())
+        {
+            std::size_t id = 0;
+            bool hasDigits = false;
+            while (i < list.size() && list[i] >= '0' && list[i] <= '9')
+            {
+                id = id * 10 + static_cast<std::size_t>(list[i++] - '0');
+                hasDigits = true;
+            }
+            if (!hasDigits)
+                return 0;
+            count = id + 1 > count ? id + 1 : count;
+            //the separators ('-', ',' and the trailing newline) don't matter, only the highest id does
+            if (i < list.size())
+                ++i;
+        }
+        return count;
+    }
+
+    /**
+    * @brief Number of NUMA nodes of the machine (without libnuma), 1 if it can't be determined.
+    */
+    inline std::size_t numa_node_count()
+    {
+        static const std::size_t nodeCount = []() -> std::size_t {
+#if defined(__linux__)
+            std::ifstream online("/sys/devices/system/node/online");
+            std::string list;
+            if (std::getline(online, list))
+            {
+                const std::size_t count = parse_id_list(list);
+                if (count > 0)
+                    return count;
+            }
+#endif
+            return 1;
+        }();
+        return nodeCount;
+    }
+
+    /**
+    * @brief The NUMA node the calling thread was running on when it first asked for it.
+    */
+    //threads can migrate, but the node has to be stable for a thread (it departs where it arrived), so it's only asked for once
+    inline std::size_t this_thread_numa_node()
+    {
+        static thread_local const std::size_t node = []() -> std::size_t {
+#if defined(__linux__) && defined(SYS_getcpu)
+            unsigned cpu = 0;
+            unsigned numaNode = 0;
+            if (syscall(SYS_getcpu, &cpu, &numaNode, nullptr) == 0)
+                return numaNode;
+#endif
+            return 0;
+        }();
+        return node;
+    }
+}
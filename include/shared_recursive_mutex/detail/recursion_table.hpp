@@ -0,0 +1,141 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mtx::detail
+{
+    /**
+    * @brief The levels of ownership one thread has for one mutex.
+    */
+    struct recursion_counters
+    {
+        uint32_t readers = 0;
+        uint32_t upgraders = 0;
+        uint32_t writers = 0;
+        //optimistic reads that failed in a row, it's not an ownership level
+        uint32_t failedValidations = 0;
+
+        [[nodiscard]] bool empty() const { return readers == 0 && upgraders == 0 && writers == 0; }
+    };
+
+    struct recursion_table_entry
+    {
+        const void* mutex = nullptr;
+        recursion_counters counters;
+    };
+
+    /**
+    * @brief Thread local open addressed table that maps the address of a mutex to the recursion counters of this thread.
+    */
+    //entries are never removed, an entry with empty counters is the same as no entry and can be reused by another mutex.
+    //because of that it doesn't matter if a mutex is destroyed and a new one gets the same address.
+    //the most recently used entry is cached, so repeatedly locking the same mutex is a compare and a load.
+    class recursion_table {
+    public:
+        static recursion_counters& find(const void* mutex)
+        {
+            if (g_mruMutex == mutex)
+                return *g_mru;
+            return find_slow(mutex);
+        }
+
+    private:
+        //has to match the shift of the hash function
+        static constexpr std::size_t TABLE_SIZE = 16;
+
+        using entry = recursion_table_entry;
+
+        static recursion_counters& find_slow(const void* mutex);
+        static recursion_counters& find_overflow(const void* mutex, entry* reusable);
+        static std::size_t hash(const void* mutex)
+        {
+            //fibonacci hashing, the top bits of the product are the best mixed ones
+            const auto address = static_cast<uint64_t>(reinterpret_cast<std::uintptr_t>(mutex));
+            return static_cast<std::size_t>((address * 0x9E3779B97F4A7C15ull) >> 60);
+        }
+
+        static inline thread_local const void* g_mruMutex = nullptr;
+        static inline thread_local recursion_counters* g_mru = nullptr;
+        static inline thread_local entry g_entries[TABLE_SIZE];
+        static inline thread_local bool g_overflowUsed = false;
+    };
+
+    inline recursion_counters& recursion_table::find_slow(const void* mutex)
+    {
+        entry* reusable = nullptr;
+        const std::size_t start = hash(mutex);
+        for (std::size_t i = 0; i < TABLE_SIZE; ++i)
+        {
+            entry& current = g_entries[(start + i) % TABLE_SIZE];
+            if (current.mutex == mutex)
+            {
+                reusable = &current;
+                break;
+            }
+            if (reusable == nullptr && current.counters.empty())
+                reusable = &current;
+            //used entries never become unused again, so the mutex can't be further down the probe sequence
+            if (current.mutex == nullptr)
+                break;
+        }
+        //the thread holds (or held) more than TABLE_SIZE mutexes at once, the mutex might live in the overflow entries
+        if (reusable == nullptr || (g_overflowUsed && (reusable->mutex != mutex || reusable->counters.empty())))
+            return find_overflow(mutex, reusable);
+
+        if (reusable->mutex != mutex)
+            reusable->counters.failedValidations = 0;
+        reusable->mutex = mutex;
+        g_mruMutex = mutex;
+        g_mru = &reusable->counters;
+        return reusable->counters;
+    }
+
+    inline recursion_counters& recursion_table::find_overflow(const void* mutex, entry* reusable)
+    {
+        static thread_local std::vector<std::unique_ptr<entry>> g_overflow;
+        entry* match = nullptr;
+        entry* unusedOverflow = nullptr;
+        std::size_t used = 0;
+        for (auto& current : g_overflow)
+        {
+            if (current->counters.empty())
+            {
+                if (unusedOverflow == nullptr)
+                    unusedOverflow = current.get();
+                continue;
+            }
+            ++used;
+            //a matching overflow entry is still in use, so it takes precedence over a reusable table entry
+            if (current->mutex == mutex)
+                match = current.get();
+        }
+        if (match != nullptr)
+        {
+            reusable = match;
+        }
+        else if (used == 0 && reusable != nullptr)
+        {
+            //no overflow entry is in use anymore, the table is enough again and the MRU entry is replaced below,
+            //so nothing points into the overflow entries and MRU misses stop scanning them
+            g_overflow.clear();
+            g_overflowUsed = false;
+        }
+        else if (reusable == nullptr)
+        {
+            g_overflowUsed = true;
+            reusable = unusedOverflow != nullptr ? unusedOverflow : g_overflow.emplace_back(std::make_unique<entry>()).get();
+        }
+
+        if (reusable->mutex != mutex)
+            reusable->counters.failedValidations = 0;
+        reusable->mutex = mutex;
+        g_mruMutex = mutex;
+        g_mru = &reusable->counters;
+        return reusable->counters;
+    }
+}
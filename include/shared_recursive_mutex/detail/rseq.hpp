@@ -0,0 +1,131 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/detail/cache_line.hpp>
+#include <shared_recursive_mutex/detail/numa.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <fstream>
+#include <sched.h>
+#include <string>
+#endif
+//the critical section is written in x86-64 assembly, glibc 2.35+ registers the rseq area of every thread.
+//it's an asm goto with an output operand, which needs gcc 11 or clang 11
+#if defined(__linux__) && defined(__x86_64__) && ((defined(__clang__) && __clang_major__ >= 11) || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 11)) && __has_include(<sys/rseq.h>)
+#include <sys/rseq.h>
+#if defined(RSEQ_SIG)
+#define SHARED_RECURSIVE_MUTEX_HAS_RSEQ 1
+#endif
+#endif
+
+namespace mtx::detail
+{
+    /**
+    * @brief Number of cpus the kernel might ever report (the highest possible cpu id + 1).
+    */
+    inline std::size_t possible_cpu_count()
+    {
+        static const std::size_t cpuCount = []() -> std::size_t {
+#if defined(__linux__)
+            std::ifstream possible("/sys/devices/system/cpu/possible");
+            std::string list;
+            if (std::getline(possible, list))
+            {
+                const std::size_t count = parse_id_list(list);
+                if (count > 0)
+                    return count;
+            }
+#endif
+            const unsigned hardwareThreads = std::thread::hardware_concurrency();
+            return hardwareThreads > 0 ? hardwareThreads : 1;
+        }();
+        return cpuCount;
+    }
+
+    /**
+    * @brief The cpu the calling thread is running on right now (it might already run somewhere else when it looks at the result).
+    */
+    inline std::size_t current_cpu()
+    {
+#if defined(__linux__)
+        const int cpu = sched_getcpu();
+        return cpu >= 0 ? static_cast<std::size_t>(cpu) : 0;
+#else
+        return 0;
+#endif
+    }
+
+    /**
+    * @brief True if the C library registered a restartable sequences area for the threads of this process.
+    */
+    inline bool rseq_available()
+    {
+#if defined(SHARED_RECURSIVE_MUTEX_HAS_RSEQ)
+        //the registration can be disabled with GLIBC_TUNABLES=glibc.pthread.rseq=0 or fail on old kernels
+        return __rseq_size > 0;
+#else
+        return false;
+#endif
+    }
+
+    /**
+    * @brief Adds value to counters[cpu] (counters are cache_line_size apart) without a lock prefix, where cpu is the cpu we run on.
+    *        Returns false if the cpu id is not below count, the caller has to fall back to an atomic add then.
+    */
+    //the add is the commit of a restartable sequence: if the thread is preempted, migrated or interrupted by a signal between reading
+    //the cpu id and the add, the kernel restarts the sequence, so the add always hits the counter of the cpu that executes it.
+    inline bool rseq_add_on_cpu(std::atomic<uint64_t>* counters, uint32_t count, uint64_t value)
+    {
+#if defined(SHARED_RECURSIVE_MUTEX_HAS_RSEQ)
+        static_assert(cache_line_size == 64, "the critical section shifts the cpu id by 6");
+        static_assert(RSEQ_SIG == 0x53053053, "the signature in front of the abort handler has to match the registered one");
+        auto* area = reinterpret_cast<struct rseq*>(static_cast<char*>(__builtin_thread_pointer()) + __rseq_offset);
+        for (;;)
+        {
+            //the descriptor and the abort handler join the section group of the function ("?"), so they are discarded
+            //together with duplicate copies of this inline function
+            __asm__ goto(
+                ".pushsection __rseq_cs, \"aw?\"\n\t"
+                ".balign 32\n\t"
+                "3:\n\t"
+                ".long 0x0, 0x0\n\t"
+                ".quad 1f, (2f - 1f), 4f\n\t"
+                ".popsection\n\t"
+                "leaq 3b(%%rip), %%rax\n\t"
+                "movq %%rax, %[rseq_cs]\n\t"
+                "1:\n\t"
+                "movl %[cpu_id], %%eax\n\t"
+                "cmpl %[count], %%eax\n\t"
+                "jae %l[out_of_range]\n\t"
+                "shlq $6, %%rax\n\t"
+                "addq %[value], (%[counters], %%rax)\n\t"
+                "2:\n\t"
+                ".pushsection __rseq_failure, \"ax?\"\n\t"
+                ".long 0x53053053\n\t"
+                "4:\n\t"
+                "jmp %l[aborted]\n\t"
+                ".popsection\n\t"
+                : [rseq_cs] "+m" (area->rseq_cs)
+                : [cpu_id] "m" (area->cpu_id), [count] "r" (count),
+                  [counters] "r" (counters), [value] "r" (value)
+                : "memory", "cc", "rax"
+                : out_of_range, aborted);
+            return true;
+        aborted:
+            continue;
+        out_of_range:
+            return false;
+        }
+#else
+        (void)counters;
+        (void)count;
+        (void)value;
+        return false;
+#endif
+    }
+}
@@ -0,0 +1,78 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <cstdint>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace mtx::detail
+{
+    /**
+    * @brief Tells the cpu that we are in a spin loop (pause on x86, yield on arm).
+    */
+    inline void cpu_relax()
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+
+    /**
+    * @brief Exponential backoff for spin loops, after MaxSpins pauses the thread yields its time slice.
+    */
+    template<uint32_t MaxSpins = 1024>
+    class backoff {
+    public:
+        void pause()
+        {
+            if (m_spins < MaxSpins)
+            {
+                for (uint32_t i = 0; i < m_spins; ++i)
+                    cpu_relax();
+                m_spins *= 2;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+        /**
+        * @brief Returns true as long as the backoff is still spinning and did not yet start to yield.
+        */
+        [[nodiscard]] bool spinning() const { return m_spins < MaxSpins; }
+
+    private:
+        uint32_t m_spins = 1;
+    };
+
+    /**
+    * @brief Exponential backoff for spin loops that never gives up the cpu, the pause stays at MaxSpins pauses once it got there.
+    */
+    //for threads that are pinned to isolated cores, where yielding or parking (a system call) is not acceptable
+    template<uint32_t MaxSpins = 1024>
+    class spin_backoff {
+    public:
+        void pause()
+        {
+            for (uint32_t i = 0; i < m_spins; ++i)
+                cpu_relax();
+            if (m_spins < MaxSpins)
+                m_spins *= 2;
+        }
+        /**
+        * @brief Returns true as long as the pause still grows, afterwards the backoff keeps spinning with MaxSpins pauses.
+        */
+        [[nodiscard]] bool spinning() const { return m_spins < MaxSpins; }
+
+    private:
+        uint32_t m_spins = 1;
+    };
+}
@@ -0,0 +1,76 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/detail/cache_line.hpp>
+#include <atomic>
+
+namespace mtx::detail
+{
+    /**
+    * @brief Process wide list of per thread records, so a writer can look at the state of every thread.
+    */
+    //a thread claims a record the first time it asks for it and gives it back when it exits, records are never freed
+    //(there are at most as many records as there were threads alive at the same time), so walking the list never races with a free.
+    //the Record is not reset when it's handed to another thread, the owner has to leave it in its idle state before it exits.
+    template<typename Record>
+    class thread_registry {
+    public:
+        struct alignas(cache_line_size) node
+        {
+            Record record{};
+            std::atomic<bool> inUse{ true };
+            node* next = nullptr;
+        };
+
+        /**
+        * @brief The record of the calling thread.
+        */
+        static Record& local()
+        {
+            static thread_local const owner g_owner;
+            return g_owner.current->record;
+        }
+        /**
+        * @brief Calls the function with every record that ever was claimed, including the ones that are currently unused.
+        */
+        template<typename Function>
+        static void for_each(Function&& function)
+        {
+            for (node* current = g_head.load(std::memory_order_acquire); current != nullptr; current = current->next)
+                function(current->record);
+        }
+
+    private:
+        struct owner
+        {
+            owner()
+            {
+                for (node* it = g_head.load(std::memory_order_acquire); it != nullptr; it = it->next)
+                {
+                    bool inUse = false;
+                    if (it->inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire, std::memory_order_relaxed))
+                    {
+                        current = it;
+                        return;
+                    }
+                }
+                current = new node;
+                current->next = g_head.load(std::memory_order_relaxed);
+                while (!g_head.compare_exchange_weak(current->next, current, std::memory_order_release, std::memory_order_relaxed))
+                {
+                }
+            }
+            ~owner()
+            {
+                current->inUse.store(false, std::memory_order_release);
+            }
+            owner(const owner&) = delete;
+            owner& operator =(const owner&) = delete;
+
+            node* current = nullptr;
+        };
+
+        static inline std::atomic<node*> g_head{ nullptr };
+    };
+}
@@ -0,0 +1,139 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/reader_indicator.hpp>
+#include <shared_recursive_mutex/detail/cache_line.hpp>
+#include <shared_recursive_mutex/detail/futex.hpp>
+#include <shared_recursive_mutex/detail/spin.hpp>
+#include <atomic>
+#include <cstdint>
+
+namespace mtx
+{
+    /**
+    * @brief "Big reader" lock: readers only touch their own counter of the ReaderIndicator, writers set a flag and drain all readers.
+    */
+    //readers never write to a cache line that is shared with other readers, so read only traffic scales with the number of cores.
+    //the price is paid by the writers, which have to scan the whole reader indicator until all readers are gone.
+    //readers that see the writer flag depart again and park until the writer is done, so waiting writers block new readers.
+    template<typename ReaderIndicator = slotted_reader_indicator<>>
+    class distributed_shared_mutex {
+    public:
+        distributed_shared_mutex() = default;
+        /**
+        * @brief Copying the mutex is not allowed
+        */
+        distributed_shared_mutex(const distributed_shared_mutex&) = delete;
+        distributed_shared_mutex& operator =(const distributed_shared_mutex&) = delete;
+
+        void lock();
+        void lock_shared();
+        void unlock();
+        void unlock_shared();
+        [[nodiscard]] bool try_lock();
+        [[nodiscard]] bool try_lock_shared();
+
+    private:
+        static constexpr uint32_t UNLOCKED = 0;
+        static constexpr uint32_t LOCKED = 1;
+        static constexpr uint32_t PARKED = 2;
+
+        void lock_slow();
+        void wait_for_writer();
+
+        ReaderIndicator m_readers;
+        //the writer flag gets its own cache line, it's read by every reader but only written by writers
+        alignas(detail::cache_line_size) std::atomic<uint32_t> m_writer{ UNLOCKED };
+    };
+
+    template<typename ReaderIndicator>
+    void distributed_shared_mutex<ReaderIndicator>::lock()
+    {
+        uint32_t writer = UNLOCKED;
+        if (!m_writer.compare_exchange_strong(writer, LOCKED, std::memory_order_seq_cst))
+            lock_slow();
+        //new readers see the flag now, so we only have to wait for the ones that are already inside
+        detail::backoff<> backoff;
+        while (!m_readers.empty())
+            backoff.pause();
+    }
+    template<typename ReaderIndicator>
+    void distributed_shared_mutex<ReaderIndicator>::lock_shared()
+    {
+        for (;;)
+        {
+            m_readers.arrive();
+            if (m_writer.load(std::memory_order_seq_cst) == UNLOCKED)
+                return;
+            m_readers.depart();
+            wait_for_writer();
+        }
+    }
+    template<typename ReaderIndicator>
+    void distributed_shared_mutex<ReaderIndicator>::unlock()
+    {
+        if (m_writer.exchange(UNLOCKED, std::memory_order_release) == PARKED)
+            detail::futex_wake_all(m_writer);
+    }
+    template<typename ReaderIndicator>
+    void distributed_shared_mutex<ReaderIndicator>::unlock_shared()
+    {
+        m_readers.depart();
+    }
+    template<typename ReaderIndicator>
+    bool distributed_shared_mutex<ReaderIndicator>::try_lock()
+    {
+        uint32_t writer = UNLOCKED;
+        if (!m_writer.compare_exchange_strong(writer, LOCKED, std::memory_order_seq_cst))
+            return false;
+        if (m_readers.empty())
+            return true;
+        unlock();
+        return false;
+    }
+    template<typename ReaderIndicator>
+    bool distributed_shared_mutex<ReaderIndicator>::try_lock_shared()
+    {
+        m_readers.arrive();
+        if (m_writer.load(std::memory_order_seq_cst) == UNLOCKED)
+            return true;
+        m_readers.depart();
+        return false;
+    }
+    template<typename ReaderIndicator>
+    void distributed_shared_mutex<ReaderIndicator>::lock_slow()
+    {
+        for (;;)
+        {
+            uint32_t writer = m_writer.load(std::memory_order_relaxed);
+            if (writer == UNLOCKED)
+            {
+                //there was contention, so somebody else might still be parked and we take the lock in the parked state
+                if (m_writer.compare_exchange_weak(writer, PARKED, std::memory_order_seq_cst))
+                    return;
+                continue;
+            }
+            if (writer == PARKED || m_writer.compare_exchange_weak(writer, PARKED, std::memory_order_relaxed))
+                detail::futex_wait(m_writer, PARKED);
+        }
+    }
+    template<typename ReaderIndicator>
+    void distributed_shared_mutex<ReaderIndicator>::wait_for_writer()
+    {
+        uint32_t writer = m_writer.load(std::memory_order_relaxed);
+        while (writer != UNLOCKED)
+        {
+            if (writer == PARKED || m_writer.compare_exchange_weak(writer, PARKED, std::memory_order_relaxed))
+                detail::futex_wait(m_writer, PARKED);
+            writer = m_writer.load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+    * @brief shared_recursive_mutex_t variant with per slot reader counters ("big reader" lock)
+    */
+    template<typename PhantomType>
+    using shared_recursive_big_reader_mutex_t = shared_recursive_mutex_t<PhantomType, distributed_shared_mutex<>>;
+}
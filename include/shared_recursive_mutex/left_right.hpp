@@ -0,0 +1,143 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/reader_indicator.hpp>
+#include <shared_recursive_mutex/detail/cache_line.hpp>
+#include <shared_recursive_mutex/detail/spin.hpp>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+namespace mtx
+{
+    /**
+    * @brief Left-right concurrency control (Ramalhete and Correia): two instances of a T, readers are wait-free and never block
+    *        writers for longer than their read, writers apply every mutation to both instances.
+    */
+    //readers arrive at the reader indicator of the current version and read the instance the left-right index points to.
+    //a writer (serialized through the shared_recursive_mutex_t of the same PhantomType) mutates the instance the readers don't
+    //use, switches the readers to it and toggles the version: it waits until the readers of the next version are gone, publishes
+    //it, and waits until the readers of the previous version are gone. Afterwards no reader can be inside the old instance anymore
+    //and the mutation is applied to it as well. Readers only do a fixed number of steps, the writers do all the waiting.
+    //a mutation has to be deterministic (both instances have to end up equal), it's applied exactly twice. If it throws, the instance
+    //it was applied to is overwritten with a copy of the other one and the exception is rethrown, so both instances stay equal.
+    //modify calls from inside a mutation are applied to the instance that is being mutated (they run twice with the outer
+    //mutation), modify calls of a thread that already has write ownership just take the next level of the recursive write lock.
+    template<typename T, typename PhantomType, typename ReaderIndicator = slotted_reader_indicator<>>
+    class left_right {
+    public:
+        using mutex_type = shared_recursive_mutex_t<PhantomType>;
+
+        explicit left_right(const T& value)
+            : m_instances{ value, value }
+        {
+        }
+        template<typename... Args>
+        explicit left_right(std::in_place_t, const Args&... args)
+            : m_instances{ T(args...), T(args...) }
+        {
+        }
+        /**
+        * @brief Copying is not allowed
+        */
+        left_right(const left_right&) = delete;
+        left_right& operator =(const left_right&) = delete;
+
+        /**
+        * @brief Calls reader(const T&) and returns its result, wait-free. Must not call modify, the writer would wait for this read.
+        */
+        template<typename Reader>
+        decltype(auto) read(Reader&& reader) const;
+        /**
+        * @brief Calls mutation(T&) on both instances, blocks until the readers have left the instance that is mutated second.
+        */
+        template<typename Mutation>
+        void modify(Mutation&& mutation);
+
+    private:
+        struct departure
+        {
+            ~departure() { indicator.depart(); }
+            ReaderIndicator& indicator;
+        };
+
+        //the readers of one version are gone
+        void wait_for_readers(uint32_t version) const;
+
+        std::array<T, 2> m_instances;
+        //mutable, so that readers can announce themselves in const member functions
+        mutable std::array<ReaderIndicator, 2> m_readers;
+        //read by every reader, only written by writers
+        alignas(detail::cache_line_size) std::atomic<uint32_t> m_leftRight{ 0 };
+        std::atomic<uint32_t> m_versionIndex{ 0 };
+        //the instance the current mutation is applied to, only accessed with the write lock
+        T* m_writing = nullptr;
+    };
+
+    template<typename T, typename PhantomType, typename ReaderIndicator>
+    template<typename Reader>
+    decltype(auto) left_right<T, PhantomType, ReaderIndicator>::read(Reader&& reader) const
+    {
+        auto& indicator = m_readers[m_versionIndex.load(std::memory_order_seq_cst)];
+        indicator.arrive();
+        const departure departGuard{ indicator };
+        return std::forward<Reader>(reader)(m_instances[m_leftRight.load(std::memory_order_seq_cst)]);
+    }
+    template<typename T, typename PhantomType, typename ReaderIndicator>
+    template<typename Mutation>
+    void left_right<T, PhantomType, ReaderIndicator>::modify(Mutation&& mutation)
+    {
+        std::unique_lock write_guard(mutex_type::instance());
+        if (m_writing != nullptr)
+        {
+            //called from inside a mutation, the outer mutation takes care of the other instance
+            mutation(*m_writing);
+            return;
+        }
+        const uint32_t front = m_leftRight.load(std::memory_order_relaxed);
+        m_writing = &m_instances[front ^ 1];
+        try
+        {
+            mutation(*m_writing);
+        }
+        catch (...)
+        {
+            //no reader uses the instance, it's reset to the front instance and the modify has no effect
+            m_writing = nullptr;
+            m_instances[front ^ 1] = m_instances[front];
+            throw;
+        }
+        m_leftRight.store(front ^ 1, std::memory_order_seq_cst);
+
+        const uint32_t version = m_versionIndex.load(std::memory_order_relaxed);
+        //readers that loaded the version index before the last toggle can still be inside the next version and read the old front instance
+        wait_for_readers(version ^ 1);
+        m_versionIndex.store(version ^ 1, std::memory_order_seq_cst);
+        wait_for_readers(version);
+
+        m_writing = &m_instances[front];
+        try
+        {
+            std::forward<Mutation>(mutation)(*m_writing);
+        }
+        catch (...)
+        {
+            //the readers already see the mutated instance, so the modify took place and the old instance catches up with a copy
+            m_writing = nullptr;
+            m_instances[front] = m_instances[front ^ 1];
+            throw;
+        }
+        m_writing = nullptr;
+    }
+    template<typename T, typename PhantomType, typename ReaderIndicator>
+    void left_right<T, PhantomType, ReaderIndicator>::wait_for_readers(uint32_t version) const
+    {
+        detail::backoff<> backoff;
+        while (!m_readers[version].empty())
+            backoff.pause();
+    }
+}
@@ -0,0 +1,23 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/distributed_shared_mutex.hpp>
+#include <shared_recursive_mutex/reader_indicator.hpp>
+
+namespace mtx
+{
+    /**
+    * @brief "Big reader" lock for data that is written very rarely (e.g. configuration reloads).
+    */
+    //readers store to a thread local slot and load the writer flag, they don't execute a single atomic read-modify-write or fence.
+    //every writer (and every failed try_lock) issues a membarrier, which interrupts all running threads of the process,
+    //so this is only a win if writes are rare. Without membarrier support (non Linux, old kernels) readers fall back to a full fence.
+    using membarrier_shared_mutex = distributed_shared_mutex<membarrier_reader_indicator<>>;
+
+    /**
+    * @brief shared_recursive_mutex_t variant for data that is written very rarely, readers only store to a thread local slot
+    */
+    template<typename PhantomType>
+    using shared_recursive_membarrier_mutex_t = shared_recursive_mutex_t<PhantomType, membarrier_shared_mutex>;
+}
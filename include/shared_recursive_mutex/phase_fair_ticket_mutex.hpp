@@ -0,0 +1,117 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/detail/cache_line.hpp>
+#include <shared_recursive_mutex/detail/spin.hpp>
+#include <atomic>
+#include <cstdint>
+
+namespace mtx
+{
+    /**
+    * @brief Phase fair ticket reader/writer lock (PF-T, Brandenburg and Anderson), readers and writers take turns.
+    */
+    //writers are served in ticket order. A writer that is next announces itself in the reader entry counter, which ends the
+    //current reader phase: readers that arrive later wait for the next phase, which starts as soon as the writer unlocks.
+    //so a reader waits for at most one writer phase and a writer for the readers of at most one reader phase (plus the writers
+    //that got a ticket before it), independent of the number of threads. The lowest bits of the reader entry counter contain
+    //the writer present bit and the phase id (the lowest bit of the writer ticket), readers wait until these bits change.
+    //all waiting is done by spinning (with backoff), the bounded latency comes at the price of burning cpu time while waiting.
+    class phase_fair_ticket_mutex {
+    public:
+        phase_fair_ticket_mutex() = default;
+        /**
+        * @brief Copying the mutex is not allowed
+        */
+        phase_fair_ticket_mutex(const phase_fair_ticket_mutex&) = delete;
+        phase_fair_ticket_mutex& operator =(const phase_fair_ticket_mutex&) = delete;
+
+        void lock();
+        void lock_shared();
+        void unlock();
+        void unlock_shared();
+        [[nodiscard]] bool try_lock();
+        [[nodiscard]] bool try_lock_shared();
+
+    private:
+        static constexpr uint32_t PHASE_ID = 1u << 0;
+        static constexpr uint32_t WRITER_PRESENT = 1u << 1;
+        static constexpr uint32_t WRITER_BITS = PHASE_ID | WRITER_PRESENT;
+        static constexpr uint32_t READER = 1u << 8;
+
+        //waits until all readers that entered before the writer bits were set have left
+        void wait_for_readers(uint32_t readerTicket);
+
+        //readers write the reader counters and writers the writer tickets, so they live on different cache lines
+        alignas(detail::cache_line_size) std::atomic<uint32_t> m_readersIn{ 0 };
+        std::atomic<uint32_t> m_readersOut{ 0 };
+        alignas(detail::cache_line_size) std::atomic<uint32_t> m_writersIn{ 0 };
+        std::atomic<uint32_t> m_writersOut{ 0 };
+    };
+
+    inline void phase_fair_ticket_mutex::lock()
+    {
+        const uint32_t ticket = m_writersIn.fetch_add(1, std::memory_order_relaxed);
+        detail::backoff<> backoff;
+        while (m_writersOut.load(std::memory_order_acquire) != ticket)
+            backoff.pause();
+        //ends the current reader phase, the readers that are inside are counted in the upper bits
+        const uint32_t readerTicket = m_readersIn.fetch_add(WRITER_PRESENT | (ticket & PHASE_ID), std::memory_order_acq_rel) & ~WRITER_BITS;
+        wait_for_readers(readerTicket);
+    }
+    inline void phase_fair_ticket_mutex::lock_shared()
+    {
+        const uint32_t writer = m_readersIn.fetch_add(READER, std::memory_order_acquire) & WRITER_BITS;
+        if (writer == 0)
+            return;
+        //the writer phase ends when the writer clears its bits, the next writer uses the other phase id
+        detail::backoff<> backoff;
+        while ((m_readersIn.load(std::memory_order_acquire) & WRITER_BITS) == writer)
+            backoff.pause();
+    }
+    inline void phase_fair_ticket_mutex::unlock()
+    {
+        m_readersIn.fetch_and(~WRITER_BITS, std::memory_order_release);
+        m_writersOut.fetch_add(1, std::memory_order_release);
+    }
+    inline void phase_fair_ticket_mutex::unlock_shared()
+    {
+        m_readersOut.fetch_add(READER, std::memory_order_release);
+    }
+    inline bool phase_fair_ticket_mutex::try_lock()
+    {
+        uint32_t ticket = m_writersOut.load(std::memory_order_relaxed);
+        if (!m_writersIn.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acquire, std::memory_order_relaxed))
+            return false;
+        const uint32_t readerTicket = m_readersIn.fetch_add(WRITER_PRESENT | (ticket & PHASE_ID), std::memory_order_acq_rel) & ~WRITER_BITS;
+        if (m_readersOut.load(std::memory_order_acquire) == readerTicket)
+            return true;
+        //the readers are still inside, we end our (empty) writer phase right away
+        unlock();
+        return false;
+    }
+    inline bool phase_fair_ticket_mutex::try_lock_shared()
+    {
+        uint32_t readers = m_readersIn.load(std::memory_order_relaxed);
+        while ((readers & WRITER_BITS) == 0)
+        {
+            if (m_readersIn.compare_exchange_weak(readers, readers + READER, std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+    inline void phase_fair_ticket_mutex::wait_for_readers(uint32_t readerTicket)
+    {
+        detail::backoff<> backoff;
+        while (m_readersOut.load(std::memory_order_acquire) != readerTicket)
+            backoff.pause();
+    }
+
+    /**
+    * @brief shared_recursive_mutex_t variant with a phase fair ticket lock, nested locks of a thread never take a ticket
+    */
+    template<typename PhantomType>
+    using shared_recursive_ticket_mutex_t = shared_recursive_mutex_t<PhantomType, phase_fair_ticket_mutex>;
+}
@@ -0,0 +1,90 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+//MSVC has no pthreads, code that uses the pthread_shared_mutex has to check SHARED_RECURSIVE_MUTEX_HAS_PTHREAD
+#if __has_include(<pthread.h>)
+#include <pthread.h>
+#include <system_error>
+#define SHARED_RECURSIVE_MUTEX_HAS_PTHREAD 1
+
+namespace mtx
+{
+    /**
+    * @brief Which kind of thread a pthread_rwlock_t prefers when readers and writers are waiting.
+    */
+    enum class pthread_rwlock_preference
+    {
+        //the platform default (prefers readers on glibc)
+        platform_default,
+        //PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP, only available on glibc.
+        //Waiting writers block new readers, so a thread must never take a second read lock while it already holds one.
+        //That is always the case when it's used as the backend of the shared_recursive_mutex_t, since recursive
+        //read locks never reach the backend.
+        prefer_writer_nonrecursive
+    };
+
+    /**
+    * @brief SharedLockable adapter for a raw pthread_rwlock_t
+    */
+    template<pthread_rwlock_preference Preference = pthread_rwlock_preference::platform_default>
+    class pthread_shared_mutex {
+    public:
+        /**
+        * @brief Initializes the pthread_rwlock_t with the given preference, throws a std::system_error if this fails.
+        */
+        pthread_shared_mutex();
+        ~pthread_shared_mutex();
+        /**
+        * @brief Copying the mutex is not allowed
+        */
+        pthread_shared_mutex(const pthread_shared_mutex&) = delete;
+        pthread_shared_mutex& operator =(const pthread_shared_mutex&) = delete;
+
+        void lock() { pthread_rwlock_wrlock(&m_rwlock); }
+        void lock_shared() { pthread_rwlock_rdlock(&m_rwlock); }
+        void unlock() { pthread_rwlock_unlock(&m_rwlock); }
+        void unlock_shared() { pthread_rwlock_unlock(&m_rwlock); }
+        [[nodiscard]] bool try_lock() { return pthread_rwlock_trywrlock(&m_rwlock) == 0; }
+        [[nodiscard]] bool try_lock_shared() { return pthread_rwlock_tryrdlock(&m_rwlock) == 0; }
+        /**
+        * @brief Returns the underlying pthread_rwlock_t.
+        */
+        [[nodiscard]] pthread_rwlock_t* native_handle() { return &m_rwlock; }
+
+    private:
+        pthread_rwlock_t m_rwlock;
+    };
+
+    template<pthread_rwlock_preference Preference>
+    pthread_shared_mutex<Preference>::pthread_shared_mutex()
+    {
+        pthread_rwlockattr_t attributes;
+        int error = pthread_rwlockattr_init(&attributes);
+        if (error != 0)
+            throw std::system_error(error, std::system_category(), "pthread_rwlockattr_init");
+        if constexpr (Preference == pthread_rwlock_preference::prefer_writer_nonrecursive)
+        {
+#if defined(__GLIBC__)
+            error = pthread_rwlockattr_setkind_np(&attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+            if (error != 0)
+            {
+                pthread_rwlockattr_destroy(&attributes);
+                throw std::system_error(error, std::system_category(), "pthread_rwlockattr_setkind_np");
+            }
+#else
+            static_assert(Preference != pthread_rwlock_preference::prefer_writer_nonrecursive, "PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP is only available on glibc");
+#endif
+        }
+        error = pthread_rwlock_init(&m_rwlock, &attributes);
+        pthread_rwlockattr_destroy(&attributes);
+        if (error != 0)
+            throw std::system_error(error, std::system_category(), "pthread_rwlock_init");
+    }
+    template<pthread_rwlock_preference Preference>
+    pthread_shared_mutex<Preference>::~pthread_shared_mutex()
+    {
+        pthread_rwlock_destroy(&m_rwlock);
+    }
+}
+#endif
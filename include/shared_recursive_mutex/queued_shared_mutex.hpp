@@ -0,0 +1,216 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/wait_policy.hpp>
+#include <shared_recursive_mutex/detail/cache_line.hpp>
+#include <shared_recursive_mutex/detail/futex.hpp>
+#include <shared_recursive_mutex/detail/spin.hpp>
+#include <atomic>
+#include <cstdint>
+
+namespace mtx
+{
+    namespace detail
+    {
+        /**
+        * @brief Queue node of a waiting thread, every waiter spins on the state of its own node.
+        */
+        struct alignas(cache_line_size) queue_node
+        {
+            static constexpr uint32_t GRANTED = 0;
+            static constexpr uint32_t WAITING = 1;
+            static constexpr uint32_t PARKED = 2;
+
+            std::atomic<queue_node*> m_next{ nullptr };
+            std::atomic<uint32_t> m_state{ GRANTED };
+        };
+    }
+
+    /**
+    * @brief Reader/writer lock that queues contended threads in FIFO order (MCS queue), every waiter spins on its own cache line.
+    */
+    //the state word contains a writer bit, a waiting writer bit, a parked bit and the reader count, the uncontended paths only touch the state word.
+    //contended threads append their node to the queue and spin (and later park) on it until their predecessor hands over the head of the queue.
+    //only the head of the queue waits on the state word: a reader increments the reader count and immediately hands the head to the next
+    //thread (so consecutive readers get the lock together), a writer announces itself with the waiting writer bit (which blocks new readers)
+    //and hands the head over once it owns the lock. Like the other waiters the head spins for a while and then parks on the state word,
+    //the parked bit tells the unlocking writer or the last reader to wake it up.
+    //a thread waits for at most one lock at a time, so one thread local node per thread is enough and acquiring the lock never allocates.
+    class queued_shared_mutex {
+    public:
+        queued_shared_mutex() = default;
+        /**
+        * @brief Copying the mutex is not allowed
+        */
+        queued_shared_mutex(const queued_shared_mutex&) = delete;
+        queued_shared_mutex& operator =(const queued_shared_mutex&) = delete;
+
+        /**
+        * @brief Locks the mutex for exclusive access, waits behind all threads that are already queued.
+        */
+        void lock();
+        /**
+        * @brief Locks the mutex for shared access, waits behind all threads that are already queued.
+        */
+        void lock_shared();
+        void unlock();
+        void unlock_shared();
+        /**
+        * @brief Tries to get exclusive ownership without blocking, fails if other threads are queued.
+        */
+        [[nodiscard]] bool try_lock();
+        /**
+        * @brief Tries to get shared ownership without blocking, fails if other threads are queued.
+        */
+        [[nodiscard]] bool try_lock_shared();
+
+    private:
+        static constexpr uint32_t WRITER = 1u << 0;
+        static constexpr uint32_t WRITER_WAITING = 1u << 1;
+        static constexpr uint32_t PARKED = 1u << 2;
+        static constexpr uint32_t READER = 1u << 3;
+
+        //appends the node of this thread to the queue and waits until it's the head of the queue
+        detail::queue_node& enqueue();
+        //hands the head of the queue over to the next thread
+        void dequeue(detail::queue_node& node);
+        //the head of the queue waits until can_acquire(state) is true and then replaces the state with acquire(state)
+        template<typename CanAcquire, typename Acquire>
+        void acquire_as_head(CanAcquire canAcquire, Acquire acquire);
+
+        static inline thread_local detail::queue_node g_node;
+
+        //both are written by every acquisition, so they share a cache line
+        std::atomic<uint32_t> m_state{ 0 };
+        std::atomic<detail::queue_node*> m_tail{ nullptr };
+    };
+
+    inline void queued_shared_mutex::lock()
+    {
+        uint32_t state = 0;
+        if (m_tail.load(std::memory_order_relaxed) == nullptr && m_state.compare_exchange_strong(state, WRITER, std::memory_order_acquire, std::memory_order_relaxed))
+            return;
+        auto& node = enqueue();
+        //new readers leave the fast path as soon as they see the waiting writer bit, we only have to wait for the owners to leave.
+        //only the head parks on the state word, so we can clear the parked bit together with the waiting writer bit
+        m_state.fetch_or(WRITER_WAITING, std::memory_order_relaxed);
+        acquire_as_head([](uint32_t current) { return (current & ~(WRITER_WAITING | PARKED)) == 0; }, [](uint32_t) { return WRITER; });
+        dequeue(node);
+    }
+    inline void queued_shared_mutex::lock_shared()
+    {
+        if (m_tail.load(std::memory_order_relaxed) == nullptr)
+        {
+            const uint32_t state = m_state.fetch_add(READER, std::memory_order_acquire);
+            if ((state & (WRITER | WRITER_WAITING)) == 0)
+                return;
+            m_state.fetch_sub(READER, std::memory_order_relaxed);
+        }
+        auto& node = enqueue();
+        //as head of the queue there can't be a waiting writer, we only have to wait for a writer that got the lock without queueing
+        m_state.fetch_add(READER, std::memory_order_acquire);
+        acquire_as_head([](uint32_t current) { return (current & WRITER) == 0; }, [](uint32_t current) { return current & ~PARKED; });
+        dequeue(node);
+    }
+    inline void queued_shared_mutex::unlock()
+    {
+        if (m_state.fetch_and(~(WRITER | PARKED), std::memory_order_release) & PARKED)
+            detail::futex_wake_all(m_state);
+    }
+    inline void queued_shared_mutex::unlock_shared()
+    {
+        //a parked head waits either for the writer (which wakes it up) or for the last reader to leave
+        const uint32_t previous = m_state.fetch_sub(READER, std::memory_order_release);
+        if ((previous & PARKED) && previous / READER == 1 && (m_state.fetch_and(~PARKED, std::memory_order_relaxed) & PARKED))
+            detail::futex_wake_all(m_state);
+    }
+    inline bool queued_shared_mutex::try_lock()
+    {
+        uint32_t state = 0;
+        return m_tail.load(std::memory_order_relaxed) == nullptr && m_state.compare_exchange_strong(state, WRITER, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+    inline bool queued_shared_mutex::try_lock_shared()
+    {
+        if (m_tail.load(std::memory_order_relaxed) != nullptr)
+            return false;
+        uint32_t state = m_state.load(std::memory_order_relaxed);
+        while ((state & (WRITER | WRITER_WAITING)) == 0)
+        {
+            if (m_state.compare_exchange_weak(state, state + READER, std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+    inline detail::queue_node& queued_shared_mutex::enqueue()
+    {
+        auto& node = g_node;
+        node.m_next.store(nullptr, std::memory_order_relaxed);
+        node.m_state.store(detail::queue_node::WAITING, std::memory_order_relaxed);
+        detail::queue_node* predecessor = m_tail.exchange(&node, std::memory_order_acq_rel);
+        if (predecessor == nullptr)
+            return node;
+        predecessor->m_next.store(&node, std::memory_order_release);
+        //spin on our own node for a while (unless there is no other cpu that could hand the lock over), then park on it
+        detail::backoff<> backoff;
+        while (detail::max_spinners() > 0 && backoff.spinning())
+        {
+            if (node.m_state.load(std::memory_order_acquire) == detail::queue_node::GRANTED)
+                return node;
+            backoff.pause();
+        }
+        uint32_t state = detail::queue_node::WAITING;
+        if (node.m_state.compare_exchange_strong(state, detail::queue_node::PARKED, std::memory_order_acquire))
+        {
+            while (node.m_state.load(std::memory_order_acquire) != detail::queue_node::GRANTED)
+                detail::futex_wait(node.m_state, detail::queue_node::PARKED);
+        }
+        return node;
+    }
+    template<typename CanAcquire, typename Acquire>
+    void queued_shared_mutex::acquire_as_head(CanAcquire canAcquire, Acquire acquire)
+    {
+        detail::backoff<> backoff;
+        for (;;)
+        {
+            uint32_t state = m_state.load(std::memory_order_relaxed);
+            if (canAcquire(state))
+            {
+                if (m_state.compare_exchange_weak(state, acquire(state), std::memory_order_acquire, std::memory_order_relaxed))
+                    return;
+                continue;
+            }
+            if (detail::max_spinners() > 0 && backoff.spinning())
+            {
+                backoff.pause();
+                continue;
+            }
+            //the owners might have left in the meantime, then the CAS fails and we check again
+            if ((state & PARKED) == 0 && !m_state.compare_exchange_weak(state, state | PARKED, std::memory_order_relaxed))
+                continue;
+            detail::futex_wait(m_state, state | PARKED);
+        }
+    }
+    inline void queued_shared_mutex::dequeue(detail::queue_node& node)
+    {
+        detail::queue_node* successor = node.m_next.load(std::memory_order_acquire);
+        if (successor == nullptr)
+        {
+            detail::queue_node* expected = &node;
+            if (m_tail.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel, std::memory_order_relaxed))
+                return;
+            //the successor has swapped the tail, but didn't link itself yet
+            while ((successor = node.m_next.load(std::memory_order_acquire)) == nullptr)
+                detail::cpu_relax();
+        }
+        if (successor->m_state.exchange(detail::queue_node::GRANTED, std::memory_order_release) == detail::queue_node::PARKED)
+            detail::futex_wake_all(successor->m_state);
+    }
+
+    /**
+    * @brief shared_recursive_mutex_t variant that queues contended threads in FIFO order
+    */
+    template<typename PhantomType>
+    using shared_recursive_queued_mutex_t = shared_recursive_mutex_t<PhantomType, queued_shared_mutex>;
+}
@@ -0,0 +1,211 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/detail/membarrier.hpp>
+#include <shared_recursive_mutex/detail/spin.hpp>
+#include <shared_recursive_mutex/detail/thread_registry.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace mtx
+{
+    namespace detail
+    {
+        /**
+        * @brief The read side state of a thread for all rcu_protected objects of one PhantomType.
+        */
+        template<typename PhantomType>
+        struct rcu_reader_record
+        {
+            //the global epoch when the outermost read section started, 0 if the thread doesn't read
+            std::atomic<uint64_t> epoch{ 0 };
+            //only touched by the owning thread
+            uint32_t nesting = 0;
+        };
+    }
+
+    /**
+    * @brief Read-copy-update protection of a T: readers get a stable pointer without blocking, writers publish a new copy.
+    */
+    //readers announce the global epoch in their thread local record (a release store and a light_fence) and load the
+    //current pointer, nested read sections only increment a thread local counter. Writers serialize through the
+    //shared_recursive_mutex_t of the same PhantomType, publish the new version and retire the old one with the current epoch,
+    //which is advanced afterwards. A retired version is deleted once every thread that is inside a read section entered it in
+    //a later epoch, the writer checks that with a heavy_fence and a scan of all reader records.
+    //retired versions are reclaimed by the following updates, by reclaim() and by synchronize().
+    //all rcu_protected objects with the same PhantomType share the epoch and the reader records.
+    template<typename T, typename PhantomType>
+    class rcu_protected {
+    public:
+        using mutex_type = shared_recursive_mutex_t<PhantomType>;
+
+        /**
+        * @brief Keeps the version of the T that was current when it was created alive, until it's destroyed.
+        */
+        class read_guard {
+        public:
+            ~read_guard() { rcu_protected::read_unlock(); }
+            read_guard(const read_guard&) = delete;
+            read_guard& operator =(const read_guard&) = delete;
+
+            const T& operator*() const { return *m_value; }
+            const T* operator->() const { return m_value; }
+            [[nodiscard]] const T* get() const { return m_value; }
+
+        private:
+            friend class rcu_protected;
+            explicit read_guard(const T* value) : m_value(value) {}
+
+            const T* m_value;
+        };
+
+        explicit rcu_protected(std::unique_ptr<T> value)
+            : m_current(value.release())
+        {
+            //registers the process for membarriers before the first reader relies on them
+            (void)detail::membarrier_available();
+        }
+        template<typename... Args>
+        explicit rcu_protected(std::in_place_t, Args&&... args)
+            : rcu_protected(std::make_unique<T>(std::forward<Args>(args)...))
+        {
+        }
+        /**
+        * @brief There must be no readers left, all versions are deleted.
+        */
+        ~rcu_protected()
+        {
+            delete m_current.load(std::memory_order_relaxed);
+        }
+        rcu_protected(const rcu_protected&) = delete;
+        rcu_protected& operator =(const rcu_protected&) = delete;
+
+        /**
+        * @brief Starts a read section, never blocks. Nested read sections of a thread don't touch any shared state.
+        */
+        [[nodiscard]] read_guard read() const;
+        /**
+        * @brief Publishes a new version, the current one is retired and deleted once no reader can see it anymore.
+        */
+        void update(std::unique_ptr<T> value);
+        /**
+        * @brief Publishes a copy of the current version that was modified by modify(T&).
+        */
+        template<typename Modify>
+        void update_copy(Modify&& modify);
+        /**
+        * @brief Deletes the retired versions that no reader can see anymore, returns how many are still waiting.
+        */
+        std::size_t reclaim();
+        /**
+        * @brief Waits until all retired versions are deleted. Must not be called inside a read section.
+        */
+        void synchronize();
+
+    private:
+        using registry = detail::thread_registry<detail::rcu_reader_record<PhantomType>>;
+
+        struct retired
+        {
+            uint64_t epoch;
+            std::unique_ptr<T> value;
+        };
+
+        static void read_unlock();
+        //the oldest epoch a reader is in, UINT64_MAX if no thread reads
+        static uint64_t oldest_reader_epoch();
+        //needs the write lock
+        std::size_t reclaim_locked();
+
+        static inline std::atomic<uint64_t> g_epoch{ 1 };
+
+        std::atomic<T*> m_current;
+        //retired versions, protected by the write lock
+        std::vector<retired> m_retired;
+    };
+
+    template<typename T, typename PhantomType>
+    typename rcu_protected<T, PhantomType>::read_guard rcu_protected<T, PhantomType>::read() const
+    {
+        auto& record = registry::local();
+        if (record.nesting++ == 0)
+        {
+            //the acquire pairs with the fetch_add in update: a reader that sees the new epoch also sees the version published before it.
+            //the release orders the reads of our previous read section before the epoch a writer sees in oldest_reader_epoch
+            record.epoch.store(g_epoch.load(std::memory_order_acquire), std::memory_order_release);
+            //the writer either sees our epoch or we see its new version: light_fence is only a compiler barrier if oldest_reader_epoch
+            //issues a membarrier (which runs a full fence on this thread), otherwise it's a seq_cst fence
+            detail::light_fence();
+        }
+        return read_guard(m_current.load(std::memory_order_acquire));
+    }
+    template<typename T, typename PhantomType>
+    void rcu_protected<T, PhantomType>::read_unlock()
+    {
+        auto& record = registry::local();
+        if (--record.nesting == 0)
+            record.epoch.store(0, std::memory_order_release);
+    }
+    template<typename T, typename PhantomType>
+    void rcu_protected<T, PhantomType>::update(std::unique_ptr<T> value)
+    {
+        std::unique_lock write_guard(mutex_type::instance());
+        std::unique_ptr<T> previous(m_current.exchange(value.release(), std::memory_order_seq_cst));
+        //readers that started before the new epoch might still see the previous version
+        m_retired.push_back({ g_epoch.fetch_add(1, std::memory_order_seq_cst), std::move(previous) });
+        reclaim_locked();
+    }
+    template<typename T, typename PhantomType>
+    template<typename Modify>
+    void rcu_protected<T, PhantomType>::update_copy(Modify&& modify)
+    {
+        std::unique_lock write_guard(mutex_type::instance());
+        //writers are serialized, so nobody can replace the current version while we copy it
+        auto copy = std::make_unique<T>(*m_current.load(std::memory_order_relaxed));
+        std::forward<Modify>(modify)(*copy);
+        update(std::move(copy));
+    }
+    template<typename T, typename PhantomType>
+    std::size_t rcu_protected<T, PhantomType>::reclaim()
+    {
+        std::unique_lock write_guard(mutex_type::instance());
+        return reclaim_locked();
+    }
+    template<typename T, typename PhantomType>
+    void rcu_protected<T, PhantomType>::synchronize()
+    {
+        detail::backoff<> backoff;
+        while (reclaim() > 0)
+            backoff.pause();
+    }
+    template<typename T, typename PhantomType>
+    uint64_t rcu_protected<T, PhantomType>::oldest_reader_epoch()
+    {
+        //pairs with the light_fence of the readers
+        detail::heavy_fence();
+        uint64_t oldest = UINT64_MAX;
+        registry::for_each([&](const detail::rcu_reader_record<PhantomType>& record) {
+            const uint64_t epoch = record.epoch.load(std::memory_order_acquire);
+            if (epoch != 0)
+                oldest = std::min(oldest, epoch);
+        });
+        return oldest;
+    }
+    template<typename T, typename PhantomType>
+    std::size_t rcu_protected<T, PhantomType>::reclaim_locked()
+    {
+        if (m_retired.empty())
+            return 0;
+        //a reader that is in the epoch a version was retired in might have loaded it before it was replaced
+        const uint64_t oldest = oldest_reader_epoch();
+        m_retired.erase(std::remove_if(m_retired.begin(), m_retired.end(), [oldest](const retired& version) { return version.epoch < oldest; }), m_retired.end());
+        return m_retired.size();
+    }
+}
@@ -0,0 +1,351 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/detail/cache_line.hpp>
+#include <shared_recursive_mutex/detail/membarrier.hpp>
+#include <shared_recursive_mutex/detail/numa.hpp>
+#include <shared_recursive_mutex/detail/rseq.hpp>
+#include <shared_recursive_mutex/detail/thread_registry.hpp>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace mtx
+{
+    //A reader indicator tracks whether there are readers, it has to provide:
+    //  void arrive()       - announces a reader of the calling thread, has to be sequentially consistent
+    //  void depart()       - removes a reader of the calling thread, has to be at least a release operation
+    //  bool empty() const  - returns true if there are no readers, has to read the state sequentially consistent
+    //a thread always departs from the same indicator it arrived at, but the indicator itself is not told which thread arrives
+
+    /**
+    * @brief Reader indicator with one counter per thread slot, every counter lives on its own cache line.
+    */
+    //threads get their slot assigned round robin the first time they arrive, readers only ever write to the
+    //cache line of their own slot. Writers have to scan all slots, so the number of slots is a tradeoff between
+    //reader scalability and writer cost.
+    template<std::size_t Slots = 64>
+    class slotted_reader_indicator {
+    public:
+        static_assert(Slots > 0, "the reader indicator needs at least one slot");
+
+        void arrive()
+        {
+            m_slots[thread_slot()].value.fetch_add(1, std::memory_order_seq_cst);
+        }
+        void depart()
+        {
+            m_slots[thread_slot()].value.fetch_sub(1, std::memory_order_release);
+        }
+        [[nodiscard]] bool empty() const
+        {
+            //or-reduction over all slots without an early exit, the loop has no data dependent branches
+            uint32_t readers = 0;
+            for (const auto& slot : m_slots)
+                readers |= slot.value.load(std::memory_order_seq_cst);
+            return readers == 0;
+        }
+
+    private:
+        static std::size_t thread_slot()
+        {
+            static std::atomic<std::size_t> g_nextSlot{ 0 };
+            static thread_local const std::size_t g_slot = g_nextSlot.fetch_add(1, std::memory_order_relaxed) % Slots;
+            return g_slot;
+        }
+
+        std::array<detail::cache_line_padded<std::atomic<uint32_t>>, Slots> m_slots{};
+    };
+
+    /**
+    * @brief Reader indicator with one counter per NUMA node, readers only write to the cache line of their own node.
+    */
+    //cache lines that are shared within a node are much cheaper than lines that bounce between sockets,
+    //and writers only have to scan one counter per node. Nodes above MaxNodes share counters.
+    template<std::size_t MaxNodes = 8>
+    class numa_reader_indicator {
+    public:
+        static_assert(MaxNodes > 0, "the reader indicator needs at least one node");
+
+        void arrive()
+        {
+            m_nodes[node_index()].value.fetch_add(1, std::memory_order_seq_cst);
+        }
+        void depart()
+        {
+            m_nodes[node_index()].value.fetch_sub(1, std::memory_order_release);
+        }
+        [[nodiscard]] bool empty() const
+        {
+            //the counters of nodes that don't exist are never used
+            const std::size_t nodes = detail::numa_node_count() < MaxNodes ? detail::numa_node_count() : MaxNodes;
+            uint32_t readers = 0;
+            for (std::size_t i = 0; i < nodes; ++i)
+                readers |= m_nodes[i].value.load(std::memory_order_seq_cst);
+            return readers == 0;
+        }
+
+    private:
+        static std::size_t node_index() { return detail::this_thread_numa_node() % MaxNodes; }
+
+        std::array<detail::cache_line_padded<std::atomic<uint32_t>>, MaxNodes> m_nodes{};
+    };
+
+    namespace detail
+    {
+        /**
+        * @brief The read locks a thread holds through membarrier_reader_indicators, one slot per indicator.
+        */
+        template<std::size_t Slots>
+        struct membarrier_reader_record
+        {
+            std::array<std::atomic<const void*>, Slots> indicators{};
+        };
+    }
+
+    /**
+    * @brief Reader indicator for (almost) write free data, readers only store to a thread local slot, the writer pays with a membarrier.
+    */
+    //arrive is only a relaxed store and a compiler barrier, which isn't sequentially consistent on its own. empty() issues a
+    //membarrier first, which runs a full fence on every thread of the process, so the stores of all readers that arrived before are
+    //visible to the scan and every reader that arrives later sees the writer flag. Without membarrier support both sides use a full fence.
+    //a thread that holds more than Slots indicators at once counts the additional ones in a shared counter.
+    template<std::size_t Slots = 8>
+    class membarrier_reader_indicator {
+    public:
+        using registry = detail::thread_registry<detail::membarrier_reader_record<Slots>>;
+
+        membarrier_reader_indicator()
+        {
+            //registers the process for membarriers before the first reader relies on them
+            (void)detail::membarrier_available();
+        }
+
+        void arrive()
+        {
+            for (auto& slot : registry::local().indicators)
+            {
+                if (slot.load(std::memory_order_relaxed) == nullptr)
+                {
+                    slot.store(this, std::memory_order_relaxed);
+                    detail::light_fence();
+                    return;
+                }
+            }
+            m_overflow.fetch_add(1, std::memory_order_seq_cst);
+        }
+        void depart()
+        {
+            for (auto& slot : registry::local().indicators)
+            {
+                if (slot.load(std::memory_order_relaxed) == this)
+                {
+                    slot.store(nullptr, std::memory_order_release);
+                    return;
+                }
+            }
+            m_overflow.fetch_sub(1, std::memory_order_release);
+        }
+        [[nodiscard]] bool empty() const
+        {
+            detail::heavy_fence();
+            if (m_overflow.load(std::memory_order_seq_cst) != 0)
+                return false;
+            bool empty = true;
+            registry::for_each([&](const auto& record) {
+                for (const auto& slot : record.indicators)
+                    empty &= slot.load(std::memory_order_acquire) != this;
+            });
+            return empty;
+        }
+
+    private:
+        std::atomic<uint32_t> m_overflow{ 0 };
+    };
+
+    /**
+    * @brief Reader indicator with one pair of counters per cpu, readers increment them with restartable sequences instead of atomics.
+    */
+    //readers count arrivals and departures on the cpu they run on, a reader that migrates departs on another cpu than it arrived,
+    //so a single counter per cpu could be negative. empty() sums up all departures first and then all arrivals: every departure that
+    //is seen belongs to an arrival that is seen as well, so a reader that is still inside always makes the sums differ.
+    //the increments are plain adds inside of restartable sequences, which the kernel restarts on preemption and migration.
+    //they are not ordered with the load of the writer flag, so like membarrier_reader_indicator the writer pays with a membarrier.
+    //the memory doesn't grow with the number of threads, but every indicator needs a cache line per possible cpu.
+    //without rseq support (non x86-64, old glibc or kernel) the counters are incremented with atomic adds on the current cpu.
+    class percpu_reader_indicator {
+    public:
+        percpu_reader_indicator()
+            : m_cpuCount(static_cast<uint32_t>(detail::possible_cpu_count()))
+            , m_rseq(detail::rseq_available() && detail::membarrier_available())
+            //one more counter for cpus that don't fit (e.g. cpus that were hot plugged after the count was read), it's only used atomically
+            , m_cpus(std::make_unique<detail::cache_line_padded<counts>[]>(m_cpuCount + 1))
+        {
+        }
+
+        void arrive()
+        {
+            if (m_rseq && detail::rseq_add_on_cpu(&m_cpus[0].value.arrivals, m_cpuCount, 1))
+                detail::light_fence();
+            else
+                fallback_counts().arrivals.fetch_add(1, std::memory_order_seq_cst);
+        }
+        void depart()
+        {
+            //x86 never reorders stores with earlier memory accesses, so the plain add is a release
+            if (!m_rseq || !detail::rseq_add_on_cpu(&m_cpus[0].value.departures, m_cpuCount, 1))
+                fallback_counts().departures.fetch_add(1, std::memory_order_release);
+        }
+        [[nodiscard]] bool empty() const
+        {
+            if (m_rseq)
+                detail::heavy_fence();
+            uint64_t departures = 0;
+            for (uint32_t i = 0; i <= m_cpuCount; ++i)
+                departures += m_cpus[i].value.departures.load(std::memory_order_seq_cst);
+            uint64_t arrivals = 0;
+            for (uint32_t i = 0; i <= m_cpuCount; ++i)
+                arrivals += m_cpus[i].value.arrivals.load(std::memory_order_seq_cst);
+            return arrivals == departures;
+        }
+
+    private:
+        struct counts
+        {
+            std::atomic<uint64_t> arrivals{ 0 };
+            std::atomic<uint64_t> departures{ 0 };
+        };
+
+        counts& fallback_counts()
+        {
+            //with rseq the counters of the cpus are written with plain adds, so atomics may only use the spare counter
+            if (m_rseq)
+                return m_cpus[m_cpuCount].value;
+            return m_cpus[detail::current_cpu() % (m_cpuCount + 1)].value;
+        }
+
+        const uint32_t m_cpuCount;
+        const bool m_rseq;
+        std::unique_ptr<detail::cache_line_padded<counts>[]> m_cpus;
+    };
+
+    /**
+    * @brief Scalable non-zero indicator (SNZI): a tree of counters where only the first arrival at and the last departure from a subtree reach its parent.
+    */
+    //readers arrive at a leaf that is picked by the cpu the thread first ran on, so threads of the same cpu share a leaf.
+    //a node counts the readers of its subtree, it only arrives at its parent when its count leaves zero and departs from it when
+    //it drops back to zero. While a subtree has readers, more readers only touch the nodes of the subtree and the root stays unchanged.
+    //the count of a node has an intermediate "half" state: the arrival that brings a node from zero to one first marks it as half,
+    //then arrives at the parent and only then completes. Readers that see the half state help with the parent arrival (and undo
+    //their extra parent arrival if somebody else completed first), so a node never counts a reader that its parent doesn't know about.
+    //the version in the upper half of a node makes sure that a help attempt from an older half state can't complete a newer one.
+    //writers only read the root counter, which is non zero exactly when there are readers.
+    template<std::size_t Leaves = 64, std::size_t Fanout = 4>
+    class snzi_reader_indicator {
+    public:
+        static_assert(Leaves > 0 && Fanout > 1, "the tree needs at least one leaf and a fanout of at least two");
+
+        void arrive()
+        {
+            arrive_at(leaf_index());
+        }
+        void depart()
+        {
+            depart_from(leaf_index());
+        }
+        [[nodiscard]] bool empty() const
+        {
+            return m_nodes[0].value.load(std::memory_order_seq_cst) == 0;
+        }
+
+    private:
+        //the counter of a node: 0 is zero, 1 is the half state and n + 1 stands for n readers
+        static constexpr uint64_t ZERO = 0;
+        static constexpr uint64_t HALF = 1;
+        static constexpr uint64_t ONE = 2;
+        static constexpr uint64_t COUNT_MASK = 0xffffffffull;
+        static constexpr uint64_t VERSION = 1ull << 32;
+
+        //the tree is a complete Fanout-ary tree in an array (the root is node 0), the leaves are the last level
+        static constexpr std::size_t leaf_count()
+        {
+            std::size_t leaves = 1;
+            while (leaves < Leaves)
+                leaves *= Fanout;
+            return leaves;
+        }
+        static constexpr std::size_t LEAF_COUNT = leaf_count();
+        static constexpr std::size_t FIRST_LEAF = (LEAF_COUNT - 1) / (Fanout - 1);
+        static constexpr std::size_t NODE_COUNT = FIRST_LEAF + LEAF_COUNT;
+
+        static std::size_t leaf_index()
+        {
+            //a thread has to depart from the leaf it arrived at, so the cpu is only asked for once
+            static thread_local const std::size_t g_leaf = FIRST_LEAF + detail::current_cpu() % LEAF_COUNT;
+            return g_leaf;
+        }
+        static std::size_t parent(std::size_t node) { return (node - 1) / Fanout; }
+
+        void arrive_at(std::size_t node)
+        {
+            auto& state = m_nodes[node].value;
+            //the root is a plain counter
+            if (node == 0)
+            {
+                state.fetch_add(1, std::memory_order_seq_cst);
+                return;
+            }
+            uint32_t undoArrivals = 0;
+            bool arrived = false;
+            uint64_t current = state.load(std::memory_order_seq_cst);
+            while (!arrived)
+            {
+                const uint64_t count = current & COUNT_MASK;
+                if (count >= ONE)
+                {
+                    arrived = state.compare_exchange_weak(current, current + 1, std::memory_order_seq_cst);
+                    continue;
+                }
+                if (count == ZERO)
+                {
+                    const uint64_t half = (current & ~COUNT_MASK) + VERSION + HALF;
+                    if (!state.compare_exchange_weak(current, half, std::memory_order_seq_cst))
+                        continue;
+                    //the half state counts us, whoever completes it
+                    arrived = true;
+                    current = half;
+                }
+                //the node is in the half state (ours or the one of another reader), the parent has to know about the subtree first
+                arrive_at(parent(node));
+                uint64_t half = current;
+                //if somebody else completed the half state (or a newer one was started), our parent arrival is one too many
+                if (!state.compare_exchange_strong(half, current + (ONE - HALF), std::memory_order_seq_cst))
+                    ++undoArrivals;
+                current = state.load(std::memory_order_seq_cst);
+            }
+            for (; undoArrivals > 0; --undoArrivals)
+                depart_from(parent(node));
+        }
+        void depart_from(std::size_t node)
+        {
+            auto& state = m_nodes[node].value;
+            if (node == 0)
+            {
+                state.fetch_sub(1, std::memory_order_seq_cst);
+                return;
+            }
+            uint64_t current = state.load(std::memory_order_relaxed);
+            //a departing reader has arrived, so the count is at least one and never in the half state
+            while (!state.compare_exchange_weak(current, (current & COUNT_MASK) == ONE ? current - ONE : current - 1, std::memory_order_seq_cst))
+            {
+            }
+            if ((current & COUNT_MASK) == ONE)
+                depart_from(parent(node));
+        }
+
+        std::array<detail::cache_line_padded<std::atomic<uint64_t>>, NODE_COUNT> m_nodes{};
+    };
+}
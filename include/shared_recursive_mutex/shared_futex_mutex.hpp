@@ -0,0 +1,570 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/detail/futex.hpp>
+#include <shared_recursive_mutex/wait_policy.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#if __has_include(<version>)
+#include <version>
+#endif
+#if defined(__cpp_lib_jthread)
+#include <stop_token>
+#endif
+
+namespace mtx
+{
+    /**
+    * @brief Which kind of waiting thread a reader/writer lock lets in first.
+    */
+    //the recursion layer never passes a recursive acquisition to the lock, so with every policy
+    //a thread that already owns the shared_recursive_mutex can't deadlock against a waiting writer.
+    enum class lock_fairness
+    {
+        //a waiting writer blocks new readers, so writers can't be starved by a constant stream of readers.
+        //Readers can be starved by a constant stream of writers.
+        writer_preferring,
+        //readers only wait for a writer that owns the lock, not for waiting writers. This gives the best read throughput,
+        //but writers can be starved as long as there is any reader.
+        reader_preferring,
+        //a waiting writer blocks new readers, but when a writer unlocks all readers that are waiting at that moment get the
+        //lock before the next writer. A reader waits for at most one writer and a writer waits for at most one phase of readers
+        //(and the writers in front of it). Up to 4095 readers can wait at the same time and up to 16383 can own or wait for the lock,
+        //further readers wait until one of them leaves (without the guarantees of the phase fair lock).
+        //the upgradeable ownership is handled like with writer_preferring.
+        phase_fair
+    };
+
+    /**
+    * @brief Reader/writer lock built on a single 32 bit atomic state word.
+    */
+    //the state word contains a writer bit, an upgrader bit, a waiting writer bit, a parked bit, a notify bit and the reader count in the remaining bits.
+    //the notify bit has no meaning, it's toggled to wake up the threads parked on the state word when a stop is requested.
+    //the WaitPolicy decides if contended threads spin before they park (see wait_policy.hpp).
+    //the uncontended paths are a single CAS, contended threads park on the state word (futex on linux).
+    //the Fairness decides if waiting writers block new readers (see lock_fairness), by default they do.
+    //with phase_fair the state word also contains a phase bit and the number of waiting readers.
+    //upgradeable ownership is shared ownership (it's counted as a reader) that only one thread at a time can have,
+    //that's why it can be promoted to exclusive ownership without releasing it.
+    template<typename WaitPolicy = park_wait_policy, lock_fairness Fairness = lock_fairness::writer_preferring>
+    class basic_shared_futex_mutex : private WaitPolicy {
+    public:
+        basic_shared_futex_mutex() = default;
+        /**
+        * @brief Copying the mutex is not allowed
+        */
+        basic_shared_futex_mutex(const basic_shared_futex_mutex&) = delete;
+        basic_shared_futex_mutex& operator =(const basic_shared_futex_mutex&) = delete;
+
+        /**
+        * @brief Locks the mutex for exclusive access, blocks as long as other threads have any kind of ownership.
+        */
+        void lock();
+        /**
+        * @brief Locks the mutex for shared access, blocks as long as a writer owns or waits for the mutex.
+        */
+        void lock_shared();
+        /**
+        * @brief Releases the exclusive ownership and wakes up all parked threads.
+        */
+        void unlock();
+        /**
+        * @brief Releases the shared ownership, the last reader wakes up the parked threads.
+        */
+        void unlock_shared();
+        /**
+        * @brief Tries to get exclusive ownership without blocking.
+        */
+        [[nodiscard]] bool try_lock();
+        /**
+        * @brief Tries to get shared ownership without blocking.
+        */
+        [[nodiscard]] bool try_lock_shared();
+        /**
+        * @brief Tries to get exclusive ownership, blocks at most until the timeout has elapsed.
+        */
+        template<typename Rep, typename Period>
+        [[nodiscard]] bool try_lock_for(const std::chrono::duration<Rep, Period>& timeout) { return try_lock_until(std::chrono::steady_clock::now() + timeout); }
+        /**
+        * @brief Tries to get exclusive ownership, blocks at most until the deadline has been reached.
+        */
+        template<typename Clock, typename Duration>
+        [[nodiscard]] bool try_lock_until(const std::chrono::time_point<Clock, Duration>& deadline);
+        /**
+        * @brief Tries to get shared ownership, blocks at most until the timeout has elapsed.
+        */
+        template<typename Rep, typename Period>
+        [[nodiscard]] bool try_lock_shared_for(const std::chrono::duration<Rep, Period>& timeout) { return try_lock_shared_until(std::chrono::steady_clock::now() + timeout); }
+        /**
+        * @brief Tries to get shared ownership, blocks at most until the deadline has been reached.
+        */
+        template<typename Clock, typename Duration>
+        [[nodiscard]] bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration>& deadline);
+
+#if defined(__cpp_lib_jthread)
+        /**
+        * @brief Locks the mutex for exclusive access like lock, but gives up and returns false when a stop is requested while waiting.
+        */
+        [[nodiscard]] bool lock(std::stop_token stop);
+        /**
+        * @brief Locks the mutex for shared access like lock_shared, but gives up and returns false when a stop is requested while waiting.
+        */
+        [[nodiscard]] bool lock_shared(std::stop_token stop);
+        /**
+        * @brief Promotes upgradeable ownership to exclusive ownership like unlock_upgrade_and_lock, but gives up and keeps the upgradeable ownership
+        *        when a stop is requested while waiting.
+        */
+        [[nodiscard]] bool unlock_upgrade_and_lock(std::stop_token stop);
+#endif
+
+        /**
+        * @brief Locks the mutex for upgradeable access, blocks as long as a writer owns or waits for the mutex or another thread has upgradeable ownership.
+        *        Other threads can still get shared ownership.
+        */
+        void lock_upgrade();
+        /**
+        * @brief Releases the upgradeable ownership.
+        */
+        void unlock_upgrade();
+        /**
+        * @brief Tries to get upgradeable ownership without blocking.
+        */
+        [[nodiscard]] bool try_lock_upgrade();
+        /**
+        * @brief Atomically promotes upgradeable ownership to exclusive ownership, blocks until all readers are gone.
+        */
+        void unlock_upgrade_and_lock();
+        /**
+        * @brief Promotes upgradeable ownership to exclusive ownership if there are no readers, otherwise keeps the upgradeable ownership.
+        */
+        [[nodiscard]] bool try_unlock_upgrade_and_lock();
+        /**
+        * @brief Promotes upgradeable ownership to exclusive ownership, if the readers don't leave until the deadline the upgradeable ownership is kept.
+        */
+        template<typename Clock, typename Duration>
+        [[nodiscard]] bool try_unlock_upgrade_and_lock_until(const std::chrono::time_point<Clock, Duration>& deadline);
+        /**
+        * @brief Atomically demotes exclusive ownership to upgradeable ownership.
+        */
+        void unlock_and_lock_upgrade();
+        /**
+        * @brief Atomically demotes upgradeable ownership to shared ownership.
+        */
+        void unlock_upgrade_and_lock_shared();
+        /**
+        * @brief Promotes shared ownership to exclusive ownership if the calling thread is the only reader, otherwise keeps the shared ownership.
+        */
+        [[nodiscard]] bool try_unlock_shared_and_lock();
+        /**
+        * @brief Atomically demotes exclusive ownership to shared ownership, no writer can get the mutex in between.
+        */
+        void unlock_and_lock_shared();
+
+        /**
+        * @brief Gives access to the wait policy, e.g. to query its statistics.
+        */
+        [[nodiscard]] const WaitPolicy& wait_policy() const { return *this; }
+
+    private:
+        static constexpr uint32_t WRITER = 1u << 0;
+        static constexpr uint32_t UPGRADER = 1u << 1;
+        static constexpr uint32_t WRITER_WAITING = 1u << 2;
+        static constexpr uint32_t PARKED = 1u << 3;
+        static constexpr uint32_t NOTIFY = 1u << 4;
+        static constexpr bool PHASE_FAIR = Fairness == lock_fairness::phase_fair;
+        //toggled when the waiting readers are let in, a waiting reader knows that it owns the lock when the phase changed
+        static constexpr uint32_t PHASE = 1u << 5;
+        static constexpr uint32_t WAITING_READER = 1u << 6;
+        static constexpr uint32_t MAX_WAITING_READERS = PHASE_FAIR ? (1u << 12) - 1 : 0;
+        static constexpr uint32_t WAITING_READERS = MAX_WAITING_READERS * WAITING_READER;
+        static constexpr uint32_t READER = PHASE_FAIR ? 1u << 18 : 1u << 6;
+        //the 26 reader bits of the other policies can't overflow (there are never that many threads), the 14 of phase_fair can
+        static constexpr uint32_t MAX_READERS = PHASE_FAIR ? (1u << 14) - 1 : ~0u / READER;
+        //bits that stay set when the lock is released, a free lock is only 0 until the first reader phase or the first stop request
+        static constexpr uint32_t KEPT_BITS = PHASE | NOTIFY;
+        //the bits a reader sets when it has to wait
+        static constexpr uint32_t READER_WAITING_BITS = PHASE_FAIR ? WAITING_READER : 0;
+
+        static constexpr uint32_t readers(uint32_t state) { return state / READER; }
+        static constexpr uint32_t waiting_readers(uint32_t state) { return (state & WAITING_READERS) / WAITING_READER; }
+        //the waiting readers are counted as well, they become owners when they are let in (released) and must fit into the reader bits
+        static constexpr bool readers_full(uint32_t state) { return PHASE_FAIR && readers(state) + waiting_readers(state) >= MAX_READERS; }
+        static constexpr bool can_lock(uint32_t state) { return (state & WRITER) == 0 && readers(state) == 0; }
+        static constexpr bool can_lock_shared(uint32_t state)
+        {
+            if constexpr (Fairness == lock_fairness::reader_preferring)
+                return (state & WRITER) == 0;
+            else
+                return (state & (WRITER | WRITER_WAITING)) == 0 && !readers_full(state);
+        }
+        static constexpr bool can_lock_upgrade(uint32_t state)
+        {
+            if constexpr (Fairness == lock_fairness::reader_preferring)
+                return (state & (WRITER | UPGRADER)) == 0;
+            else
+                return (state & (WRITER | UPGRADER | WRITER_WAITING)) == 0 && !readers_full(state);
+        }
+        //the state after the writer is gone, with phase_fair the waiting readers own the lock now
+        static constexpr uint32_t released(uint32_t state)
+        {
+            state &= ~(WRITER | WRITER_WAITING | PARKED);
+            if constexpr (PHASE_FAIR)
+            {
+                if (waiting_readers(state) > 0)
+                    state = ((state & ~WAITING_READERS) + waiting_readers(state) * READER) ^ PHASE;
+            }
+            return state;
+        }
+        //the upgrader is the only reader left
+        static constexpr bool can_promote(uint32_t state) { return readers(state) == 1; }
+        //the reader is the only reader left and it's not the upgrader
+        static constexpr bool can_promote_shared(uint32_t state) { return readers(state) == 1 && (state & UPGRADER) == 0; }
+
+        //parks until can_acquire(state) is true and then replaces the state with acquire(state).
+        //the waiting bits are set while the thread is parked
+        template<typename CanAcquire, typename Acquire>
+        void acquire_slow(CanAcquire canAcquire, Acquire acquire, uint32_t waitingBits);
+        //same as acquire_slow, but gives up when park(waitingState) returns false
+        template<typename CanAcquire, typename Acquire, typename Park>
+        bool acquire_slow(CanAcquire canAcquire, Acquire acquire, uint32_t waitingBits, Park park);
+#if defined(__cpp_lib_jthread)
+        template<typename CanAcquire, typename Acquire>
+        bool acquire_until_stopped(CanAcquire canAcquire, Acquire acquire, uint32_t waitingBits, const std::stop_token& stop);
+#endif
+        template<typename CanAcquire, typename Acquire>
+        bool acquire_until(CanAcquire canAcquire, Acquire acquire, uint32_t waitingBits, std::chrono::steady_clock::time_point deadline);
+        //with phase_fair waiting readers don't take the lock themselves, they wait until a writer lets them in
+        template<typename Park>
+        bool acquire_shared_phase_fair(Park park);
+        template<typename CanAcquire, typename Acquire>
+        bool try_acquire(CanAcquire canAcquire, Acquire acquire);
+        //replaces the state with released(state) + added and wakes up the parked threads
+        void release(uint32_t added, std::memory_order order);
+        void wake_parked();
+
+        std::atomic<uint32_t> m_state{ 0 };
+    };
+
+    template<typename WaitPolicy, lock_fairness Fairness>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::lock()
+    {
+        uint32_t state = 0;
+        if (m_state.compare_exchange_strong(state, WRITER, std::memory_order_acquire, std::memory_order_relaxed))
+            return;
+        if ((state & ~KEPT_BITS) != 0 || !m_state.compare_exchange_strong(state, state | WRITER, std::memory_order_acquire, std::memory_order_relaxed))
+            acquire_slow(can_lock, [](uint32_t current) { return current | WRITER; }, WRITER_WAITING);
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::lock_shared()
+    {
+        uint32_t state = m_state.load(std::memory_order_relaxed);
+        if (!can_lock_shared(state) || !m_state.compare_exchange_weak(state, state + READER, std::memory_order_acquire, std::memory_order_relaxed))
+            acquire_slow(can_lock_shared, [](uint32_t current) { return current + READER; }, READER_WAITING_BITS);
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::unlock()
+    {
+        if constexpr (PHASE_FAIR)
+        {
+            release(0, std::memory_order_release);
+        }
+        else
+        {
+            //clearing the waiting writer bit is fine, waiting writers set it again after they have been woken up
+            const uint32_t previous = m_state.fetch_and(~(WRITER | WRITER_WAITING | PARKED), std::memory_order_release);
+            if (previous & PARKED)
+                detail::futex_wake_all(m_state);
+        }
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::unlock_shared()
+    {
+        const uint32_t previous = m_state.fetch_sub(READER, std::memory_order_release);
+        //only the last reader can unblock someone, parked readers wait for a writer which waits for the readers to leave
+        //(or for an upgrader which waits to be the only reader left), or readers that wait because all reader bits were in use
+        const uint32_t remaining = readers(previous) - 1;
+        if ((previous & PARKED) && (remaining == 0 || (remaining == 1 && (previous & UPGRADER)) || readers_full(previous)))
+            wake_parked();
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::try_lock()
+    {
+        return try_acquire(can_lock, [](uint32_t current) { return current | WRITER; });
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::try_lock_shared()
+    {
+        return try_acquire(can_lock_shared, [](uint32_t current) { return current + READER; });
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::lock_upgrade()
+    {
+        uint32_t state = m_state.load(std::memory_order_relaxed);
+        if (!can_lock_upgrade(state) || !m_state.compare_exchange_weak(state, state + UPGRADER + READER, std::memory_order_acquire, std::memory_order_relaxed))
+            acquire_slow(can_lock_upgrade, [](uint32_t current) { return current + UPGRADER + READER; }, 0);
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::unlock_upgrade()
+    {
+        //parked threads are either writers waiting for the readers to leave or threads waiting for the upgradeable ownership
+        if (m_state.fetch_sub(UPGRADER + READER, std::memory_order_release) & PARKED)
+            wake_parked();
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::try_lock_upgrade()
+    {
+        return try_acquire(can_lock_upgrade, [](uint32_t current) { return current + UPGRADER + READER; });
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::unlock_upgrade_and_lock()
+    {
+        //while we wait for the readers to leave we block new readers like any other waiting writer
+        if (!try_unlock_upgrade_and_lock())
+            acquire_slow(can_promote, [](uint32_t current) { return (current - UPGRADER - READER) | WRITER; }, WRITER_WAITING);
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::try_unlock_upgrade_and_lock()
+    {
+        return try_acquire(can_promote, [](uint32_t current) { return (current - UPGRADER - READER) | WRITER; });
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::unlock_and_lock_upgrade()
+    {
+        //parked readers can get in now
+        release(UPGRADER + READER, std::memory_order_release);
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::unlock_and_lock_shared()
+    {
+        //parked readers can get in now, parked writers have to wait for us again
+        release(READER, std::memory_order_release);
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::unlock_upgrade_and_lock_shared()
+    {
+        if (m_state.fetch_sub(UPGRADER, std::memory_order_release) & PARKED)
+            wake_parked();
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::try_unlock_shared_and_lock()
+    {
+        //a waiting writer doesn't matter here, it has to wait for us anyway
+        return try_acquire(can_promote_shared, [](uint32_t current) { return (current - READER) | WRITER; });
+    }
+#if defined(__cpp_lib_jthread)
+    template<typename WaitPolicy, lock_fairness Fairness>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::lock(std::stop_token stop)
+    {
+        return acquire_until_stopped(can_lock, [](uint32_t current) { return current | WRITER; }, WRITER_WAITING, stop);
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::lock_shared(std::stop_token stop)
+    {
+        return acquire_until_stopped(can_lock_shared, [](uint32_t current) { return current + READER; }, READER_WAITING_BITS, stop);
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::unlock_upgrade_and_lock(std::stop_token stop)
+    {
+        //like unlock_upgrade_and_lock we block new readers while we wait, otherwise a steady stream of readers would starve us
+        return acquire_until_stopped(can_promote, [](uint32_t current) { return (current - UPGRADER - READER) | WRITER; }, WRITER_WAITING, stop);
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    template<typename CanAcquire, typename Acquire>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::acquire_until_stopped(CanAcquire canAcquire, Acquire acquire, uint32_t waitingBits, const std::stop_token& stop)
+    {
+        if (try_acquire(canAcquire, acquire))
+            return true;
+        //changing the state word makes sure that a thread which checked the stop token right before the stop was requested
+        //doesn't park (the futex compares the state word), or is woken up if it's already parked
+        std::stop_callback notify(stop, [this]() {
+            m_state.fetch_xor(NOTIFY, std::memory_order_relaxed);
+            detail::futex_wake_all(m_state);
+        });
+        return acquire_slow(canAcquire, acquire, waitingBits, [this, &stop](uint32_t waiting) {
+            if (stop.stop_requested())
+                return false;
+            detail::futex_wait(m_state, waiting);
+            return true;
+        });
+    }
+#endif
+    template<typename WaitPolicy, lock_fairness Fairness>
+    template<typename Clock, typename Duration>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::try_lock_until(const std::chrono::time_point<Clock, Duration>& deadline)
+    {
+        return acquire_until(can_lock, [](uint32_t current) { return current | WRITER; }, WRITER_WAITING, detail::to_steady_deadline(deadline));
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    template<typename Clock, typename Duration>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::try_lock_shared_until(const std::chrono::time_point<Clock, Duration>& deadline)
+    {
+        return acquire_until(can_lock_shared, [](uint32_t current) { return current + READER; }, READER_WAITING_BITS, detail::to_steady_deadline(deadline));
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    template<typename Clock, typename Duration>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::try_unlock_upgrade_and_lock_until(const std::chrono::time_point<Clock, Duration>& deadline)
+    {
+        return acquire_until(can_promote, [](uint32_t current) { return (current - UPGRADER - READER) | WRITER; }, WRITER_WAITING, detail::to_steady_deadline(deadline));
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    template<typename CanAcquire, typename Acquire>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::acquire_slow(CanAcquire canAcquire, Acquire acquire, uint32_t waitingBits)
+    {
+        acquire_slow(canAcquire, acquire, waitingBits, [this](uint32_t waiting) {
+            detail::futex_wait(m_state, waiting);
+            return true;
+        });
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    template<typename CanAcquire, typename Acquire, typename Park>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::acquire_slow(CanAcquire canAcquire, Acquire acquire, uint32_t waitingBits, Park park)
+    {
+        if constexpr (PHASE_FAIR)
+        {
+            if (waitingBits == WAITING_READER)
+                return acquire_shared_phase_fair(park);
+        }
+        WaitPolicy::spin([this, canAcquire]() { return canAcquire(m_state.load(std::memory_order_relaxed)); });
+        bool parked = false;
+        for (;;)
+        {
+            uint32_t state = m_state.load(std::memory_order_relaxed);
+            if (canAcquire(state))
+            {
+                if (m_state.compare_exchange_weak(state, acquire(state), std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    WaitPolicy::acquired(parked);
+                    return true;
+                }
+                continue;
+            }
+            //announce that we are waiting (a waiting writer blocks new readers) and that someone has to wake us up
+            const uint32_t waiting = state | waitingBits | PARKED;
+            if (state != waiting && !m_state.compare_exchange_weak(state, waiting, std::memory_order_relaxed))
+                continue;
+            if (!park(waiting))
+                break;
+            parked = true;
+        }
+        //a writer that gives up must not leave the waiting writer bit behind, the parked readers would never be woken up.
+        //other waiting writers are woken up as well and set it again
+        if (waitingBits & WRITER_WAITING)
+        {
+            if constexpr (PHASE_FAIR)
+            {
+                //the readers that wait for us are let in, unless another writer owns the lock (it lets them in when it unlocks)
+                uint32_t state = m_state.load(std::memory_order_relaxed);
+                while (!m_state.compare_exchange_weak(state, (state & WRITER) ? state & ~(WRITER_WAITING | PARKED) : released(state), std::memory_order_relaxed, std::memory_order_relaxed))
+                {
+                }
+                if (state & PARKED)
+                    detail::futex_wake_all(m_state);
+            }
+            else if (m_state.fetch_and(~(WRITER_WAITING | PARKED), std::memory_order_relaxed) & PARKED)
+            {
+                detail::futex_wake_all(m_state);
+            }
+        }
+        return false;
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    template<typename Park>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::acquire_shared_phase_fair(Park park)
+    {
+        WaitPolicy::spin([this]() { return can_lock_shared(m_state.load(std::memory_order_relaxed)); });
+        //take the lock or queue up as waiting reader
+        uint32_t state = m_state.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (can_lock_shared(state))
+            {
+                if (m_state.compare_exchange_weak(state, state + READER, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    WaitPolicy::acquired(false);
+                    return true;
+                }
+            }
+            //too many waiting or owning readers, this one waits without the guarantees of the phase fair lock.
+            //a reader that only waits because of the owning readers must not queue up, no writer would let it in
+            else if (waiting_readers(state) == MAX_WAITING_READERS || readers_full(state))
+            {
+                return acquire_slow(can_lock_shared, [](uint32_t current) { return current + READER; }, 0, park);
+            }
+            else if (m_state.compare_exchange_weak(state, (state + WAITING_READER) | PARKED, std::memory_order_relaxed, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        const uint32_t phase = state & PHASE;
+        for (;;)
+        {
+            state = m_state.load(std::memory_order_acquire);
+            if ((state & PHASE) != phase)
+                break;
+            //the last reader clears the parked bit when it wakes up a writer, so we have to set it again
+            if ((state & PARKED) == 0 && !m_state.compare_exchange_weak(state, state | PARKED, std::memory_order_relaxed))
+                continue;
+            if (!park(state | PARKED))
+            {
+                //we can only leave the queue if we haven't been let in yet
+                state = m_state.load(std::memory_order_relaxed);
+                while ((state & PHASE) == phase)
+                {
+                    if (m_state.compare_exchange_weak(state, state - WAITING_READER, std::memory_order_relaxed))
+                    {
+                        //readers that wait because all reader bits were in use can get in now
+                        if (readers_full(state) && (state & PARKED))
+                            wake_parked();
+                        return false;
+                    }
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                break;
+            }
+        }
+        WaitPolicy::acquired(true);
+        return true;
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    template<typename CanAcquire, typename Acquire>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::acquire_until(CanAcquire canAcquire, Acquire acquire, uint32_t waitingBits, std::chrono::steady_clock::time_point deadline)
+    {
+        if (try_acquire(canAcquire, acquire))
+            return true;
+        return acquire_slow(canAcquire, acquire, waitingBits, [this, deadline](uint32_t waiting) {
+            return detail::futex_wait_until(m_state, waiting, deadline);
+        });
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    template<typename CanAcquire, typename Acquire>
+    bool basic_shared_futex_mutex<WaitPolicy, Fairness>::try_acquire(CanAcquire canAcquire, Acquire acquire)
+    {
+        uint32_t state = m_state.load(std::memory_order_relaxed);
+        while (canAcquire(state))
+        {
+            if (m_state.compare_exchange_weak(state, acquire(state), std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::release(uint32_t added, std::memory_order order)
+    {
+        uint32_t state = m_state.load(std::memory_order_relaxed);
+        while (!m_state.compare_exchange_weak(state, released(state) + added, order, std::memory_order_relaxed))
+        {
+        }
+        if (state & PARKED)
+            detail::futex_wake_all(m_state);
+    }
+    template<typename WaitPolicy, lock_fairness Fairness>
+    void basic_shared_futex_mutex<WaitPolicy, Fairness>::wake_parked()
+    {
+        if (m_state.fetch_and(~PARKED, std::memory_order_relaxed) & PARKED)
+            detail::futex_wake_all(m_state);
+    }
+
+    using shared_futex_mutex = basic_shared_futex_mutex<>;
+}
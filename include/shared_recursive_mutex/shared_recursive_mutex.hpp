@@ -2,206 +2,991 @@
 // SPDX-License-Identifier: MIT
 
 #pragma once
-#include <shared_mutex>
+#include <shared_recursive_mutex/shared_futex_mutex.hpp>
+#include <shared_recursive_mutex/detail/recursion_table.hpp>
+#include <shared_recursive_mutex/detail/backend_traits.hpp>
+#include <shared_recursive_mutex/detail/spin.hpp>
+#include <shared_recursive_mutex/upgrade_lock.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
 
 namespace mtx
 {
     /**
-    * @brief Implementation of a fast shared_recursive_mutex
+    * @brief Returned by read_begin, has to be handed to the matching read_validate.
     */
-    //the template parameter is needed to be able to define multiple instances of the shared_recursive_mutex 
-    //since the implementation relies upon thread local storage we need a unique type per lock that is needed
-    //is doesn't matter what the input type is, along as it's unique (that's why it's called PhantomType)
-    template<typename PhantomType>
-    class shared_recursive_mutex_t {
-    public:
+    struct read_token
+    {
+        enum class kind : uint8_t
+        {
+            //the reader didn't take the lock, the version is validated at the end
+            optimistic,
+            //the thread already owns the mutex, nothing can change
+            nested,
+            //the reader took a real read lock, read_validate releases it
+            locked
+        };
+
+        uint64_t version = 0;
+        kind mode = kind::locked;
+    };
+
+    namespace detail
+    {
         /**
-        * @brief Copying the mutex is not allowed
+        * @brief A write closure that was handed to combine, it lives on the stack of the waiting thread.
         */
-        shared_recursive_mutex_t(const shared_recursive_mutex_t&) = delete;
-        shared_recursive_mutex_t& operator =(const shared_recursive_mutex_t&) = delete;
+        struct combine_request
+        {
+            void (*invoke)(void* closure) = nullptr;
+            void* closure = nullptr;
+            combine_request* next = nullptr;
+            std::exception_ptr error;
+            std::atomic<bool> done{ false };
+        };
+
         /**
-        * @brief The shared_recursive_mutex_t is relying on thread local storage, so there can only be 1 valid instance of it
+        * @brief A write that was handed to defer_write, owned by the queue until it's executed.
         */
-        static shared_recursive_mutex_t& instance()
+        struct deferred_write
         {
-            static shared_recursive_mutex_t instance;
-            return instance;
-        }
+            //runs the write if execute is true and deletes it
+            void (*finish)(deferred_write* self, bool execute) noexcept = nullptr;
+            deferred_write* next = nullptr;
+        };
+        template<typename Function>
+        struct deferred_write_closure : deferred_write
+        {
+            explicit deferred_write_closure(Function&& closure)
+                : function(std::move(closure))
+            {
+                finish = [](deferred_write* self, bool execute) noexcept {
+                    std::unique_ptr<deferred_write_closure> write(static_cast<deferred_write_closure*>(self));
+                    if (execute)
+                        write->function();
+                };
+            }
 
-        /**
-         * @brief Locks the mutex for exclusive write access for this thread.
-         *              Blocks execution as long as write access is not available:
-         *              * other thread has write access
-         *              * other threads try to get write access
-         *              * other threads have read access
-         *
-         *              A thread may call lock repeatedly.
-         *              Ownership will only be released after the thread makes a matching number of calls to unlock.
-         */
-        void lock();
+            Function function;
+        };
 
         /**
-         * @brief Locks the mutex for sharable read access.
-         *        Blocks execution as long as read access is not available:
-         *        * other thread has write access
-         *        * other threads try to get write access
-         *
-         *        A thread may call lock repeatedly. If the thread already has write access the level of write access will be increased.
-         *        Ownership will only be released after the thread makes a matching number of calls to unlock_shared.
-         */
-        void lock_shared();
+        * @brief The closures published by combine and the writes queued by defer_write for one mutex, the latest one first.
+        */
+        struct write_queues
+        {
+            write_queues() = default;
+            //writes that are still queued are discarded
+            ~write_queues()
+            {
+                deferred_write* write = deferred.load(std::memory_order_acquire);
+                while (write != nullptr)
+                {
+                    deferred_write* next = write->next;
+                    write->finish(write, false);
+                    write = next;
+                }
+            }
+            write_queues(const write_queues&) = delete;
+            write_queues& operator =(const write_queues&) = delete;
 
-        /**
-         * @brief Unlocks the mutex for this thread if its level of write ownership is 1 and has no read ownership.
-         *        If the thread has write ownership of 1 and read ownership, the mutex will change from write to read access.
-         *        Otherwise reduces the level of ownership by 1.
-         */
-        void unlock();
+            std::atomic<combine_request*> combined{ nullptr };
+            std::atomic<deferred_write*> deferred{ nullptr };
+        };
 
         /**
-         * @brief Unlocks the mutex for this thread if its level of ownership is 1. Otherwise reduces the level of ownership
-         *              by 1.
-         */
-        void unlock_shared();
-        /**
-        * @brief Tries to get write ownership if possible. If the thread has read (but no write) ownership this function returns false,
-        *        because to upgrade a read lock to a write lock we have to give up read ownership, so if we can't aquire write ownership
-        *        we have to reaquire the read ownership again, which might be a blocking operation. Use try_lock_upgrade is this
-        *        is the wanted behavior.
-        */
-        [[nodiscard]] bool try_lock();
-        /**
-        * @brief Tries to get read ownership if possible.
+        * @brief Implementation of the recursion logic that is shared by all shared recursive mutexes
         */
-        [[nodiscard]] bool try_lock_shared();
-        /**
-        * @brief Returns if this thread has write ownership.
-        */
-        [[nodiscard]] bool is_locked() const;
-        /**
-        * @brief Returns true if this thread has only read ownership.
-        */
-        [[nodiscard]]  bool is_locked_shared() const;
+        //Derived has to provide a thread_counters() function that returns the recursion counters of the calling thread for this mutex
+        //and a WRITE_QUEUES constant, if it's true a write_queues() function that returns the queues of combine and defer_write
+        template<typename Derived, typename Backend>
+        class shared_recursive_mutex_base {
+        public:
+            /**
+            * @brief Copying the mutex is not allowed
+            */
+            shared_recursive_mutex_base(const shared_recursive_mutex_base&) = delete;
+            shared_recursive_mutex_base& operator =(const shared_recursive_mutex_base&) = delete;
 
-    private:
-        shared_recursive_mutex_t() = default;
+            /**
+             * @brief Locks the mutex for exclusive write access for this thread.
+             *              Blocks execution as long as write access is not available:
+             *              * other thread has write access
+             *              * other threads try to get write access
+             *              * other threads have read access
+             *
+             *              A thread may call lock repeatedly.
+             *              Ownership will only be released after the thread makes a matching number of calls to unlock.
+             */
+            void lock();
 
-        std::shared_mutex m_sharedMtx;
-        static inline thread_local uint32_t g_readers = 0;
-        static inline thread_local uint32_t g_writers = 0;
-    };
+            /**
+             * @brief Locks the mutex for sharable read access.
+             *        Blocks execution as long as read access is not available:
+             *        * other thread has write access
+             *        * other threads try to get write access
+             *
+             *        A thread may call lock repeatedly. If the thread already has write access the level of write access will be increased.
+             *        Ownership will only be released after the thread makes a matching number of calls to unlock_shared.
+             */
+            void lock_shared();
 
-    template<typename PhantomType>
-    void shared_recursive_mutex_t<PhantomType>::lock()
-    {
-        if (g_writers == 0 && g_readers == 0)
+            /**
+             * @brief Unlocks the mutex for this thread if its level of write ownership is 1 and has no read ownership.
+             *        If the thread has write ownership of 1 and read ownership, the mutex will change from write to read access
+             *        (atomically if the backend supports it, so no other writer can get the mutex in between).
+             *        Otherwise reduces the level of ownership by 1.
+             *        After a downgrade the write levels became read levels, so unlock releases one level of read ownership.
+             */
+            void unlock();
+            /**
+             * @brief Atomically changes the write ownership of this thread into read ownership (into upgradeable ownership
+             *        if the thread got write ownership through it). Every level of write ownership becomes a level of read ownership,
+             *        so the matching calls to unlock (e.g. from a std::unique_lock) release the read ownership afterwards.
+             *        Does nothing if the thread has no write ownership.
+             */
+            void downgrade();
+
+            /**
+             * @brief Unlocks the mutex for this thread if its level of ownership is 1. Otherwise reduces the level of ownership
+             *              by 1.
+             */
+            void unlock_shared();
+            /**
+            * @brief Tries to get write ownership if possible. If the thread has read (but no write) ownership this function returns false,
+            *        because to upgrade a read lock to a write lock we have to give up read ownership, so if we can't aquire write ownership
+            *        we have to reaquire the read ownership again, which might be a blocking operation. Use try_lock_upgrade if this
+            *        is the wanted behavior.
+            */
+            [[nodiscard]] bool try_lock();
+            /**
+            * @brief Tries to get write ownership without giving up the read ownership of this thread. If the thread has read (but no write)
+            *        ownership and is the only reader, the read ownership is promoted in place, otherwise this function returns false
+            *        and the thread keeps its read ownership. Without read ownership this is the same as try_lock.
+            *        The write ownership falls back to read ownership with the matching call to unlock.
+            *        Always fails for read ownership if the backend can't promote shared ownership (e.g. std::shared_mutex).
+            */
+            [[nodiscard]] bool try_lock_upgrade();
+            /**
+            * @brief Tries to get read ownership if possible.
+            */
+            [[nodiscard]] bool try_lock_shared();
+#if defined(__cpp_lib_jthread)
+            /**
+            * @brief Same as lock, but gives up waiting and returns false when a stop is requested. If the thread had read ownership
+            *        it has read ownership again after giving up (this can block until the current writer is done).
+            *        Backends that can't be stopped while waiting (everything but mtx::shared_futex_mutex) are polled with try_lock.
+            */
+            [[nodiscard]] bool lock(std::stop_token stop);
+            /**
+            * @brief Same as lock_shared, but gives up waiting and returns false when a stop is requested.
+            */
+            [[nodiscard]] bool lock_shared(std::stop_token stop);
+#endif
+            /**
+            * @brief Tries to get write ownership, blocks at most until the timeout has elapsed. Returns immediately if the thread already
+            *        has write ownership and fails immediately if the thread has only read ownership (see try_lock).
+            *        Upgradeable ownership is promoted if the other readers leave in time.
+            *        Requires a backend that models SharedTimedMutex (e.g. mtx::shared_futex_mutex, std::shared_timed_mutex).
+            */
+            template<typename Rep, typename Period>
+            [[nodiscard]] bool try_lock_for(const std::chrono::duration<Rep, Period>& timeout);
+            /**
+            * @brief Same as try_lock_for, but with a deadline.
+            */
+            template<typename Clock, typename Duration>
+            [[nodiscard]] bool try_lock_until(const std::chrono::time_point<Clock, Duration>& deadline);
+            /**
+            * @brief Tries to get read ownership, blocks at most until the timeout has elapsed. Returns immediately if the thread
+            *        already has any kind of ownership.
+            */
+            template<typename Rep, typename Period>
+            [[nodiscard]] bool try_lock_shared_for(const std::chrono::duration<Rep, Period>& timeout);
+            /**
+            * @brief Same as try_lock_shared_for, but with a deadline.
+            */
+            template<typename Clock, typename Duration>
+            [[nodiscard]] bool try_lock_shared_until(const std::chrono::time_point<Clock, Duration>& deadline);
+            /**
+            * @brief Returns if this thread has write ownership.
+            */
+            [[nodiscard]] bool is_locked() const;
+            /**
+            * @brief Returns true if this thread has only read ownership.
+            */
+            [[nodiscard]]  bool is_locked_shared() const;
+
+            /**
+            * @brief Locks the mutex for upgradeable access. Only one thread at a time can have upgradeable ownership, but other
+            *        threads can still get read ownership. A thread with upgradeable ownership can call lock to get write ownership
+            *        without giving up its ownership in between, so everything that was read stays valid.
+            *        Blocks execution as long as:
+            *        * other thread has write or upgradeable access
+            *        * other threads try to get write access
+            *
+            *        A thread may call lock_upgradeable repeatedly. If the thread already has write access the level of write access will be increased.
+            *        If the thread has only read access, the read ownership is given up to get upgradeable ownership (otherwise
+            *        two readers that try to get upgradeable ownership would deadlock) and it's reacquired when the upgradeable ownership
+            *        is released.
+            *        Ownership will only be released after the thread makes a matching number of calls to unlock_upgradeable.
+            *        Calls to lock_shared while the thread has upgradeable ownership increase the level of upgradeable ownership.
+            *        Requires a backend that supports upgradeable ownership (e.g. mtx::shared_futex_mutex).
+            */
+            void lock_upgradeable();
+            /**
+            * @brief Unlocks the upgradeable ownership for this thread if its level of upgradeable ownership is 1. Otherwise reduces
+            *        the level of ownership by 1. If the thread has read ownership it atomically changes to read access.
+            */
+            void unlock_upgradeable();
+            /**
+            * @brief Tries to get upgradeable ownership if possible. If the thread has read (but no write or upgradeable) ownership
+            *        this function returns false, for the same reason try_lock does.
+            */
+            [[nodiscard]] bool try_lock_upgradeable();
+            /**
+            * @brief Returns true if this thread has upgradeable, but no write ownership.
+            */
+            [[nodiscard]] bool is_locked_upgradeable() const;
+            /**
+            * @brief Starts an optimistic read: `auto token = m.read_begin(); ...copy the data...; if (!m.read_validate(token)) retry;`
+            *        With a versioned backend (mtx::versioned_shared_mutex) the reader doesn't write to shared memory at all,
+            *        but it can see torn data, which must not be used before read_validate returned true.
+            *        If the thread already owns the mutex the read is always valid. If a writer is active, after
+            *        Backend::max_failed_validations failed validations in a row and with backends that don't support optimistic reads
+            *        the thread takes a real read lock instead, which read_validate releases.
+            */
+            [[nodiscard]] read_token read_begin();
+            /**
+            * @brief Returns true if no writer interfered since the matching read_begin, has to be called exactly once per read_begin.
+            */
+            [[nodiscard]] bool read_validate(const read_token& token);
+            /**
+            * @brief Runs function() with write ownership, but not necessarily on this thread: the closure is published and the thread
+            *        that holds or gets the write ownership next runs all published closures in one batch before it releases it.
+            *        Returns when the closure was executed, exceptions are rethrown in this thread. If the thread already has write or
+            *        upgradeable ownership the closure runs right away. Read ownership is given up while the thread waits (the
+            *        executing thread needs write ownership) and reacquired afterwards, like for lock.
+            */
+            template<typename Function>
+            void combine(Function&& function);
+            /**
+            * @brief Queues function() to be run with write ownership later and returns right away, it never blocks.
+            *        The queued writes are run in one batch by the next thread that releases its write ownership, or by
+            *        drain_deferred_writes (e.g. called by a mtx::deferred_write_drainer). A thread with write ownership runs the
+            *        write right away. The function is moved into the queue, it must not throw (that terminates the program).
+            *        Writes that are still queued when the mutex is destroyed are discarded.
+            */
+            template<typename Function>
+            void defer_write(Function&& function);
+            /**
+            * @brief Takes the write ownership (like lock) if writes are queued and runs them.
+            */
+            void drain_deferred_writes();
+            /**
+            * @brief Gives access to the underlying lock, e.g. to query its statistics.
+            */
+            [[nodiscard]] Backend& backend();
+
+        protected:
+            shared_recursive_mutex_base() = default;
+            ~shared_recursive_mutex_base() = default;
+
+        private:
+            //the Derived class decides where the thread local recursion counters of this mutex live
+            recursion_counters& thread_counters() const { return static_cast<const Derived*>(this)->thread_counters(); }
+            //only used if Derived::WRITE_QUEUES is true
+            write_queues& queues() { return static_cast<Derived*>(this)->write_queues(); }
+
+            //the upgraders counter can only be > 0 if the backend supports upgradeable ownership
+            static constexpr bool UPGRADEABLE = supports_upgrade_v<Backend>;
+            static constexpr bool PROMOTABLE = supports_shared_promotion_v<Backend>;
+            static constexpr bool DOWNGRADABLE = supports_downgrade_v<Backend>;
+            static constexpr bool OPTIMISTIC = supports_optimistic_read_v<Backend>;
+
+            //changes the exclusive ownership of the backend to shared ownership
+            void unlock_and_lock_shared();
+            //runs the queued writes and the published closures, needs write ownership
+            void run_pending();
+            void run_combined();
+#if defined(__cpp_lib_jthread)
+            //calls tryAcquire until it succeeds or a stop is requested
+            template<typename TryAcquire>
+            static bool poll_until_stopped(TryAcquire tryAcquire, const std::stop_token& stop);
+#endif
+
+            Backend m_sharedMtx;
+        };
+
+        template<typename Derived, typename Backend>
+        void shared_recursive_mutex_base<Derived, Backend>::lock()
         {
-            m_sharedMtx.lock();
+            auto& counters = thread_counters();
+            if constexpr (UPGRADEABLE)
+            {
+                //upgradeable ownership can be promoted without giving it up
+                if (counters.writers == 0 && counters.upgraders > 0)
+                {
+                    m_sharedMtx.unlock_upgrade_and_lock();
+                    ++counters.writers;
+                    return;
+                }
+            }
+            if (counters.writers == 0 && counters.readers == 0)
+            {
+                m_sharedMtx.lock();
+            }
+            else if (counters.writers == 0 && counters.readers > 0)
+            {
+                m_sharedMtx.unlock_shared();
+                m_sharedMtx.lock();
+            }
+            ++counters.writers;
         }
-        else if (g_writers == 0 && g_readers > 0)
+        template<typename Derived, typename Backend>
+        void shared_recursive_mutex_base<Derived, Backend>::lock_shared()
         {
-            m_sharedMtx.unlock_shared();
-            m_sharedMtx.lock();
+            auto& counters = thread_counters();
+            //if we are locking shared
+            if (counters.writers > 0)
+            {
+                ++counters.writers;
+            }
+            else if (counters.upgraders > 0)
+            {
+                ++counters.upgraders;
+            }
+            else if (counters.readers > 0)
+            {
+                ++counters.readers;
+            }
+            else if (counters.readers == 0)
+            {
+                m_sharedMtx.lock_shared();
+                ++counters.readers;
+            }
         }
-        ++g_writers;
-    }
-    template<typename PhantomType>
-    void shared_recursive_mutex_t<PhantomType>::lock_shared()
-    {
-        //if we are locking shared
-        if (g_writers > 0)
+        template<typename Derived, typename Backend>
+        void shared_recursive_mutex_base<Derived, Backend>::unlock()
         {
-            ++g_writers;
+            auto& counters = thread_counters();
+            //the write ownership was downgraded
+            if (counters.writers == 0)
+            {
+                unlock_shared();
+                return;
+            }
+            //the closures run with our write ownership, so they can lock the mutex again
+            if (counters.writers == 1)
+                run_pending();
+            --counters.writers;
+            if (counters.writers > 0)
+                return;
+            if constexpr (UPGRADEABLE)
+            {
+                if (counters.upgraders > 0)
+                {
+                    m_sharedMtx.unlock_and_lock_upgrade();
+                    return;
+                }
+            }
+            if (counters.readers > 0)
+                unlock_and_lock_shared();
+            else
+                m_sharedMtx.unlock();
         }
-        else if (g_readers > 0)
+        template<typename Derived, typename Backend>
+        void shared_recursive_mutex_base<Derived, Backend>::downgrade()
         {
-            ++g_readers;
+            auto& counters = thread_counters();
+            if (counters.writers == 0)
+                return;
+            run_pending();
+            if constexpr (UPGRADEABLE)
+            {
+                if (counters.upgraders > 0)
+                {
+                    counters.upgraders += std::exchange(counters.writers, 0);
+                    m_sharedMtx.unlock_and_lock_upgrade();
+                    return;
+                }
+            }
+            counters.readers += std::exchange(counters.writers, 0);
+            unlock_and_lock_shared();
         }
-        else if (g_readers == 0)
+        template<typename Derived, typename Backend>
+        void shared_recursive_mutex_base<Derived, Backend>::unlock_and_lock_shared()
         {
-            m_sharedMtx.lock_shared();
-            ++g_readers;
+            if constexpr (DOWNGRADABLE)
+            {
+                m_sharedMtx.unlock_and_lock_shared();
+            }
+            else
+            {
+                //another writer can get the mutex in between
+                m_sharedMtx.unlock();
+                m_sharedMtx.lock_shared();
+            }
         }
-    }
-    template<typename PhantomType>
-    void shared_recursive_mutex_t<PhantomType>::unlock()
-    {
-        --g_writers;
-        if (g_writers > 0)
-            return;
-        if (g_writers == 0)
+        template<typename Derived, typename Backend>
+        void shared_recursive_mutex_base<Derived, Backend>::run_pending()
         {
-            m_sharedMtx.unlock();
-            if (g_readers > 0)
-                m_sharedMtx.lock_shared();
+            if constexpr (Derived::WRITE_QUEUES)
+            {
+                //the writes were queued before the closures of the waiting threads, which might depend on them
+                auto& deferred = queues().deferred;
+                if (deferred.load(std::memory_order_relaxed) != nullptr)
+                {
+                    deferred_write* write = deferred.exchange(nullptr, std::memory_order_acquire);
+                    deferred_write* batch = nullptr;
+                    while (write != nullptr)
+                        write = std::exchange(write->next, std::exchange(batch, write));
+                    while (batch != nullptr)
+                    {
+                        deferred_write* next = batch->next;
+                        batch->finish(batch, true);
+                        batch = next;
+                    }
+                }
+                run_combined();
+            }
         }
-    }
-    template<typename PhantomType>
-    void shared_recursive_mutex_t<PhantomType>::unlock_shared()
-    {
-        //if the g_writers are > 0 it means that when we got the read lock, this thread already has the write lock
-        if (g_writers > 0)
+        template<typename Derived, typename Backend>
+        void shared_recursive_mutex_base<Derived, Backend>::run_combined()
         {
-            unlock();
-            return;
+            auto& combined = queues().combined;
+            if (combined.load(std::memory_order_relaxed) == nullptr)
+                return;
+            combine_request* request = combined.exchange(nullptr, std::memory_order_acquire);
+            //the stack has the latest request on top, they are executed in the order they were published
+            combine_request* batch = nullptr;
+            while (request != nullptr)
+                request = std::exchange(request->next, std::exchange(batch, request));
+            while (batch != nullptr)
+            {
+                //the waiting thread can return and destroy the request as soon as it's marked as done
+                combine_request* next = batch->next;
+                try
+                {
+                    batch->invoke(batch->closure);
+                }
+                catch (...)
+                {
+                    batch->error = std::current_exception();
+                }
+                batch->done.store(true, std::memory_order_release);
+                batch = next;
+            }
         }
-        --g_readers;
-        if (g_readers == 0)
+        template<typename Derived, typename Backend>
+        void shared_recursive_mutex_base<Derived, Backend>::unlock_shared()
         {
-            m_sharedMtx.unlock_shared();
+            auto& counters = thread_counters();
+            //if the writers are > 0 it means that when we got the read lock, this thread already has the write lock
+            if (counters.writers > 0)
+            {
+                unlock();
+                return;
+            }
+            //same for the upgradeable ownership
+            if (counters.upgraders > 0)
+            {
+                unlock_upgradeable();
+                return;
+            }
+            --counters.readers;
+            if (counters.readers == 0)
+            {
+                m_sharedMtx.unlock_shared();
+            }
         }
-    }
-    template<typename PhantomType>
-    bool shared_recursive_mutex_t<PhantomType>::try_lock()
-    {
-        //we already have the lock, so we can simply increase the writer count
-        if (g_writers > 0)
+        template<typename Derived, typename Backend>
+        bool shared_recursive_mutex_base<Derived, Backend>::try_lock()
         {
-            ++g_writers;
-            return true;
+            auto& counters = thread_counters();
+            //we already have the lock, so we can simply increase the writer count
+            if (counters.writers > 0)
+            {
+                ++counters.writers;
+                return true;
+            }
+            //upgradeable ownership can be promoted if there are no other readers
+            if constexpr (UPGRADEABLE)
+            {
+                if (counters.upgraders > 0)
+                {
+                    const bool promoted = m_sharedMtx.try_unlock_upgrade_and_lock();
+                    if (promoted)
+                        ++counters.writers;
+                    return promoted;
+                }
+            }
+            //we already have a read lock, but we can't aquire the write lock without giving up the read lock
+            //so we have to return false here
+            if (counters.readers > 0)
+            {
+                return false;
+            }
+            const bool aquiredLock = m_sharedMtx.try_lock();
+            if (aquiredLock)
+            {
+                ++counters.writers;
+            }
+
+            return aquiredLock;
         }
-        //we already have a read lock, but we can't aquire the write lock without giving up the read lock
-        //so we have to return false here
-        if (g_readers > 0)
+        template<typename Derived, typename Backend>
+        bool shared_recursive_mutex_base<Derived, Backend>::try_lock_upgrade()
         {
+            auto& counters = thread_counters();
+            if (counters.writers > 0 || counters.upgraders > 0 || counters.readers == 0)
+            {
+                return try_lock();
+            }
+            //we only have read ownership, if we are the only reader the backend can turn it into write ownership in place
+            if constexpr (PROMOTABLE)
+            {
+                if (m_sharedMtx.try_unlock_shared_and_lock())
+                {
+                    ++counters.writers;
+                    return true;
+                }
+            }
             return false;
         }
-        const bool aquiredLock = m_sharedMtx.try_lock();
-        if (aquiredLock)
+        template<typename Derived, typename Backend>
+        bool shared_recursive_mutex_base<Derived, Backend>::try_lock_shared()
         {
-            ++g_writers;
+            auto& counters = thread_counters();
+            //we already have the lock, so we can simply increase the lock count
+            if (counters.writers > 0 || counters.upgraders > 0 || counters.readers > 0)
+            {
+                lock_shared();
+                return true;
+            }
+            const bool aquiredLock = m_sharedMtx.try_lock_shared();
+            if (aquiredLock)
+            {
+                ++counters.readers;
+            }
+            return aquiredLock;
         }
-
-        return aquiredLock;
-    }
-    template<typename PhantomType>
-    bool shared_recursive_mutex_t<PhantomType>::try_lock_shared()
-    {
-        //we already have the lock, so we can simply increase the lock count
-        if (g_writers > 0 || g_readers > 0)
+#if defined(__cpp_lib_jthread)
+        template<typename Derived, typename Backend>
+        bool shared_recursive_mutex_base<Derived, Backend>::lock(std::stop_token stop)
         {
-            lock_shared();
+            auto& counters = thread_counters();
+            if (counters.writers > 0)
+            {
+                ++counters.writers;
+                return true;
+            }
+            bool aquiredLock = false;
+            if constexpr (UPGRADEABLE)
+            {
+                if (counters.upgraders > 0)
+                {
+                    //polling never announces the waiting writer, so it's only the fallback for backends that can't wait for the promotion
+                    if constexpr (supports_stoppable_upgrade_v<Backend>)
+                        aquiredLock = m_sharedMtx.unlock_upgrade_and_lock(stop);
+                    else
+                        aquiredLock = poll_until_stopped([this]() { return m_sharedMtx.try_unlock_upgrade_and_lock(); }, stop);
+                    if (aquiredLock)
+                        ++counters.writers;
+                    return aquiredLock;
+                }
+            }
+            if (counters.readers > 0)
+                m_sharedMtx.unlock_shared();
+            if constexpr (supports_stop_token_v<Backend>)
+                aquiredLock = m_sharedMtx.lock(stop);
+            else
+                aquiredLock = poll_until_stopped([this]() { return m_sharedMtx.try_lock(); }, stop);
+            if (aquiredLock)
+                ++counters.writers;
+            //the read ownership has to be restored, otherwise the recursion counters are wrong
+            else if (counters.readers > 0)
+                m_sharedMtx.lock_shared();
+            return aquiredLock;
+        }
+        template<typename Derived, typename Backend>
+        bool shared_recursive_mutex_base<Derived, Backend>::lock_shared(std::stop_token stop)
+        {
+            auto& counters = thread_counters();
+            if (counters.writers > 0 || counters.upgraders > 0 || counters.readers > 0)
+            {
+                lock_shared();
+                return true;
+            }
+            bool aquiredLock = false;
+            if constexpr (supports_stop_token_v<Backend>)
+                aquiredLock = m_sharedMtx.lock_shared(stop);
+            else
+                aquiredLock = poll_until_stopped([this]() { return m_sharedMtx.try_lock_shared(); }, stop);
+            if (aquiredLock)
+                ++counters.readers;
+            return aquiredLock;
+        }
+        template<typename Derived, typename Backend>
+        template<typename TryAcquire>
+        bool shared_recursive_mutex_base<Derived, Backend>::poll_until_stopped(TryAcquire tryAcquire, const std::stop_token& stop)
+        {
+            backoff_for<Backend> wait;
+            while (!tryAcquire())
+            {
+                if (stop.stop_requested())
+                    return false;
+                wait.pause();
+            }
             return true;
         }
-        const bool aquiredLock = m_sharedMtx.try_lock_shared();
-        if (aquiredLock)
+#endif
+        template<typename Derived, typename Backend>
+        template<typename Rep, typename Period>
+        bool shared_recursive_mutex_base<Derived, Backend>::try_lock_for(const std::chrono::duration<Rep, Period>& timeout)
         {
-            ++g_readers;
+            return try_lock_until(std::chrono::steady_clock::now() + timeout);
+        }
+        template<typename Derived, typename Backend>
+        template<typename Clock, typename Duration>
+        bool shared_recursive_mutex_base<Derived, Backend>::try_lock_until(const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            static_assert(supports_timed_lock_v<Backend>, "the backend doesn't support timed acquisition");
+            auto& counters = thread_counters();
+            //only the first level acquisition waits for the deadline
+            if (counters.writers > 0)
+            {
+                ++counters.writers;
+                return true;
+            }
+            if constexpr (UPGRADEABLE)
+            {
+                if (counters.upgraders > 0)
+                {
+                    bool promoted = false;
+                    if constexpr (supports_timed_upgrade_v<Backend>)
+                        promoted = m_sharedMtx.try_unlock_upgrade_and_lock_until(deadline);
+                    else
+                        promoted = m_sharedMtx.try_unlock_upgrade_and_lock();
+                    if (promoted)
+                        ++counters.writers;
+                    return promoted;
+                }
+            }
+            //same as for try_lock, we can't wait for the write lock without giving up the read lock
+            if (counters.readers > 0)
+            {
+                return false;
+            }
+            const bool aquiredLock = m_sharedMtx.try_lock_until(deadline);
+            if (aquiredLock)
+            {
+                ++counters.writers;
+            }
+            return aquiredLock;
+        }
+        template<typename Derived, typename Backend>
+        template<typename Rep, typename Period>
+        bool shared_recursive_mutex_base<Derived, Backend>::try_lock_shared_for(const std::chrono::duration<Rep, Period>& timeout)
+        {
+            return try_lock_shared_until(std::chrono::steady_clock::now() + timeout);
+        }
+        template<typename Derived, typename Backend>
+        template<typename Clock, typename Duration>
+        bool shared_recursive_mutex_base<Derived, Backend>::try_lock_shared_until(const std::chrono::time_point<Clock, Duration>& deadline)
+        {
+            static_assert(supports_timed_lock_v<Backend>, "the backend doesn't support timed acquisition");
+            auto& counters = thread_counters();
+            if (counters.writers > 0 || counters.upgraders > 0 || counters.readers > 0)
+            {
+                lock_shared();
+                return true;
+            }
+            const bool aquiredLock = m_sharedMtx.try_lock_shared_until(deadline);
+            if (aquiredLock)
+            {
+                ++counters.readers;
+            }
+            return aquiredLock;
+        }
+        template<typename Derived, typename Backend>
+        bool shared_recursive_mutex_base<Derived, Backend>::is_locked() const
+        {
+            auto& counters = thread_counters();
+            return counters.writers > 0;
+        }
+        template<typename Derived, typename Backend>
+        bool shared_recursive_mutex_base<Derived, Backend>::is_locked_shared() const
+        {
+            auto& counters = thread_counters();
+            return counters.readers > 0 && counters.upgraders == 0 && counters.writers == 0;
+        }
+        template<typename Derived, typename Backend>
+        void shared_recursive_mutex_base<Derived, Backend>::lock_upgradeable()
+        {
+            static_assert(UPGRADEABLE, "the backend doesn't support upgradeable ownership");
+            auto& counters = thread_counters();
+            if (counters.writers > 0)
+            {
+                ++counters.writers;
+            }
+            else if (counters.upgraders > 0)
+            {
+                ++counters.upgraders;
+            }
+            else if (counters.readers > 0)
+            {
+                m_sharedMtx.unlock_shared();
+                m_sharedMtx.lock_upgrade();
+                ++counters.upgraders;
+            }
+            else
+            {
+                m_sharedMtx.lock_upgrade();
+                ++counters.upgraders;
+            }
+        }
+        template<typename Derived, typename Backend>
+        void shared_recursive_mutex_base<Derived, Backend>::unlock_upgradeable()
+        {
+            auto& counters = thread_counters();
+            //if the writers are > 0 it means that when we got the upgradeable lock, this thread already had the write lock
+            if (counters.writers > 0)
+            {
+                unlock();
+                return;
+            }
+            --counters.upgraders;
+            if constexpr (UPGRADEABLE)
+            {
+                if (counters.upgraders > 0)
+                    return;
+                if (counters.readers > 0)
+                    m_sharedMtx.unlock_upgrade_and_lock_shared();
+                else
+                    m_sharedMtx.unlock_upgrade();
+            }
+        }
+        template<typename Derived, typename Backend>
+        bool shared_recursive_mutex_base<Derived, Backend>::try_lock_upgradeable()
+        {
+            static_assert(UPGRADEABLE, "the backend doesn't support upgradeable ownership");
+            auto& counters = thread_counters();
+            if (counters.writers > 0 || counters.upgraders > 0)
+            {
+                lock_upgradeable();
+                return true;
+            }
+            if (counters.readers > 0)
+            {
+                return false;
+            }
+            const bool aquiredLock = m_sharedMtx.try_lock_upgrade();
+            if (aquiredLock)
+            {
+                ++counters.upgraders;
+            }
+            return aquiredLock;
+        }
+        template<typename Derived, typename Backend>
+        bool shared_recursive_mutex_base<Derived, Backend>::is_locked_upgradeable() const
+        {
+            auto& counters = thread_counters();
+            return counters.upgraders > 0 && counters.writers == 0;
+        }
+        template<typename Derived, typename Backend>
+        read_token shared_recursive_mutex_base<Derived, Backend>::read_begin()
+        {
+            auto& counters = thread_counters();
+            if (!counters.empty())
+                return { 0, read_token::kind::nested };
+            if constexpr (OPTIMISTIC)
+            {
+                if (counters.failedValidations < Backend::max_failed_validations)
+                {
+                    //an odd version means that a writer is active, the read would fail anyway
+                    const uint64_t version = m_sharedMtx.read_begin();
+                    if ((version & 1) == 0)
+                        return { version, read_token::kind::optimistic };
+                }
+            }
+            lock_shared();
+            return { 0, read_token::kind::locked };
+        }
+        template<typename Derived, typename Backend>
+        bool shared_recursive_mutex_base<Derived, Backend>::read_validate(const read_token& token)
+        {
+            if (token.mode == read_token::kind::nested)
+                return true;
+            auto& counters = thread_counters();
+            if (token.mode == read_token::kind::locked)
+            {
+                unlock_shared();
+                counters.failedValidations = 0;
+                return true;
+            }
+            if constexpr (OPTIMISTIC)
+            {
+                if (m_sharedMtx.read_validate(token.version))
+                {
+                    counters.failedValidations = 0;
+                    return true;
+                }
+            }
+            ++counters.failedValidations;
+            return false;
+        }
+        template<typename Derived, typename Backend>
+        template<typename Function>
+        void shared_recursive_mutex_base<Derived, Backend>::combine(Function&& function)
+        {
+            static_assert(Derived::WRITE_QUEUES, "the mutex has no write queues (e.g. the compact_shared_recursive_mutex)");
+            auto& counters = thread_counters();
+            if (counters.writers > 0 || counters.upgraders > 0)
+            {
+                std::unique_lock write_guard(*this);
+                std::forward<Function>(function)();
+                return;
+            }
+            combine_request request;
+            request.closure = std::addressof(function);
+            request.invoke = [](void* closure) { (*static_cast<std::remove_reference_t<Function>*>(closure))(); };
+            auto& combined = queues().combined;
+            request.next = combined.load(std::memory_order_relaxed);
+            while (!combined.compare_exchange_weak(request.next, &request, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+            if (counters.readers > 0)
+                m_sharedMtx.unlock_shared();
+            //waiting threads poll for their closure and the write lock for a short time, so the closures of a burst end up in one batch.
+            //afterwards they block on the write lock, try_lock alone can starve while other threads keep holding read locks
+            bool executing = false;
+            detail::backoff_for<Backend> backoff;
+            while (!request.done.load(std::memory_order_acquire))
+            {
+                if (m_sharedMtx.try_lock())
+                {
+                    executing = true;
+                    break;
+                }
+                if (!backoff.spinning())
+                {
+                    m_sharedMtx.lock();
+                    executing = true;
+                    break;
+                }
+                backoff.pause();
+            }
+            if (executing)
+            {
+                //unlock runs the batch (our own closure included) and goes back to read ownership if we had it
+                ++counters.writers;
+                unlock();
+            }
+            else if (counters.readers > 0)
+            {
+                m_sharedMtx.lock_shared();
+            }
+            if (request.error)
+                std::rethrow_exception(request.error);
+        }
+        template<typename Derived, typename Backend>
+        template<typename Function>
+        void shared_recursive_mutex_base<Derived, Backend>::defer_write(Function&& function)
+        {
+            static_assert(Derived::WRITE_QUEUES, "the mutex has no write queues (e.g. the compact_shared_recursive_mutex)");
+            if (thread_counters().writers > 0)
+            {
+                std::forward<Function>(function)();
+                return;
+            }
+            deferred_write* write = new deferred_write_closure<std::decay_t<Function>>(std::decay_t<Function>(std::forward<Function>(function)));
+            auto& deferred = queues().deferred;
+            write->next = deferred.load(std::memory_order_relaxed);
+            while (!deferred.compare_exchange_weak(write->next, write, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+        template<typename Derived, typename Backend>
+        void shared_recursive_mutex_base<Derived, Backend>::drain_deferred_writes()
+        {
+            static_assert(Derived::WRITE_QUEUES, "the mutex has no write queues (e.g. the compact_shared_recursive_mutex)");
+            if (queues().deferred.load(std::memory_order_acquire) == nullptr)
+                return;
+            //the write ownership is released by the unlock, which runs the queue
+            std::unique_lock write_guard(*this);
+        }
+        template<typename Derived, typename Backend>
+        Backend& shared_recursive_mutex_base<Derived, Backend>::backend()
+        {
+            return m_sharedMtx;
         }
-        return aquiredLock;
-    }
-    template<typename PhantomType>
-    bool shared_recursive_mutex_t<PhantomType>::is_locked() const
-    {
-        return g_writers > 0;
     }
+
+    /**
+    * @brief Implementation of a fast shared_recursive_mutex
+    */
+    //the template parameter is needed to be able to define multiple instances of the shared_recursive_mutex 
+    //since the implementation relies upon thread local storage we need a unique type per lock that is needed
+    //is doesn't matter what the input type is, along as it's unique (that's why it's called PhantomType)
+    //the Backend is the lock that is used for the first level acquisitions, it has to model SharedLockable
+    //(std::shared_mutex, std::shared_timed_mutex, mtx::pthread_shared_mutex, mtx::shared_futex_mutex, ...)
+    template<typename PhantomType, typename Backend = shared_futex_mutex>
+    class shared_recursive_mutex_t : public detail::shared_recursive_mutex_base<shared_recursive_mutex_t<PhantomType, Backend>, Backend> {
+    public:
+        /**
+        * @brief The shared_recursive_mutex_t is relying on thread local storage, so there can only be 1 valid instance of it
+        */
+        static shared_recursive_mutex_t& instance()
+        {
+            static shared_recursive_mutex_t instance;
+            return instance;
+        }
+
+    private:
+        friend class detail::shared_recursive_mutex_base<shared_recursive_mutex_t, Backend>;
+        shared_recursive_mutex_t() = default;
+
+        static constexpr bool WRITE_QUEUES = true;
+        static detail::recursion_counters& thread_counters() { return g_counters; }
+        detail::write_queues& write_queues() { return m_writeQueues; }
+
+        static inline thread_local detail::recursion_counters g_counters;
+        detail::write_queues m_writeQueues;
+    };
+
+    /**
+    * @brief shared recursive mutex that can be constructed like a normal mutex, without the need for a PhantomType per lock
+    */
+    //the recursion counters of a thread are stored in a thread local table which is keyed by the address of the mutex,
+    //the lookup is a bit more expensive than the static thread local counters of the shared_recursive_mutex_t
+    template<typename Backend = shared_futex_mutex>
+    class basic_shared_recursive_mutex : public detail::shared_recursive_mutex_base<basic_shared_recursive_mutex<Backend>, Backend> {
+    public:
+        basic_shared_recursive_mutex() = default;
+
+    private:
+        friend class detail::shared_recursive_mutex_base<basic_shared_recursive_mutex, Backend>;
+
+        static constexpr bool WRITE_QUEUES = true;
+        detail::recursion_counters& thread_counters() const { return detail::recursion_table::find(this); }
+        detail::write_queues& write_queues() { return m_writeQueues; }
+
+        detail::write_queues m_writeQueues;
+    };
+
+    /**
+    * @brief shared_recursive_mutex_t variant that spins for a short time before it parks contended threads
+    */
     template<typename PhantomType>
-    bool shared_recursive_mutex_t<PhantomType>::is_locked_shared() const
-    {
-        return g_readers > 0 && g_writers == 0;
-    }
+    using shared_recursive_adaptive_mutex_t = shared_recursive_mutex_t<PhantomType, basic_shared_futex_mutex<adaptive_spin_wait_policy<>>>;
 
     using shared_recursive_global_mutex = shared_recursive_mutex_t<struct AnonymousType>;
+    using shared_recursive_mutex = basic_shared_recursive_mutex<>;
 
 }
@@ -0,0 +1,190 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/detail/cache_line.hpp>
+#include <shared_recursive_mutex/detail/spin.hpp>
+#include <atomic>
+#include <cstdint>
+
+namespace mtx
+{
+    /**
+    * @brief Reader/writer spin lock with upgradeable ownership that never enters the kernel, it occupies exactly one cache line.
+    */
+    //meant for threads that are pinned to isolated cores: waiting threads spin with pause and a bounded exponential backoff,
+    //they never yield or park, so there is no system call on any path. On an oversubscribed system this burns a lot of cpu time.
+    //the state word has the same layout as the one of the shared_futex_mutex (without the parked bits): a writer bit, an upgrader bit,
+    //a waiting writer bit and the reader count. Like the writer_preferring shared_futex_mutex a waiting writer blocks new readers,
+    //every spinning writer sets the waiting writer bit again after the previous writer cleared it.
+    class alignas(detail::cache_line_size) shared_spin_mutex {
+    public:
+        shared_spin_mutex() = default;
+        /**
+        * @brief Copying the mutex is not allowed
+        */
+        shared_spin_mutex(const shared_spin_mutex&) = delete;
+        shared_spin_mutex& operator =(const shared_spin_mutex&) = delete;
+
+        /**
+        * @brief No path of the lock yields or parks, the recursion layer spins with detail::spin_backoff instead of yielding as well.
+        */
+        static constexpr bool never_enters_kernel = true;
+
+        void lock();
+        void lock_shared();
+        void unlock();
+        void unlock_shared();
+        [[nodiscard]] bool try_lock();
+        [[nodiscard]] bool try_lock_shared();
+
+        /**
+        * @brief Locks the mutex for upgradeable access, spins as long as a writer owns or waits for the mutex or another thread has upgradeable ownership.
+        */
+        void lock_upgrade();
+        void unlock_upgrade();
+        [[nodiscard]] bool try_lock_upgrade();
+        /**
+        * @brief Atomically promotes upgradeable ownership to exclusive ownership, spins until all readers are gone.
+        */
+        void unlock_upgrade_and_lock();
+        [[nodiscard]] bool try_unlock_upgrade_and_lock();
+        void unlock_and_lock_upgrade();
+        void unlock_upgrade_and_lock_shared();
+        /**
+        * @brief Promotes shared ownership to exclusive ownership if this is the only reader, otherwise keeps the shared ownership.
+        */
+        [[nodiscard]] bool try_unlock_shared_and_lock();
+        /**
+        * @brief Atomically demotes exclusive ownership to shared ownership.
+        */
+        void unlock_and_lock_shared();
+
+    private:
+        static constexpr uint32_t WRITER = 1u << 0;
+        static constexpr uint32_t UPGRADER = 1u << 1;
+        static constexpr uint32_t WRITER_WAITING = 1u << 2;
+        static constexpr uint32_t READER = 1u << 3;
+
+        static constexpr uint32_t readers(uint32_t state) { return state / READER; }
+        static constexpr bool can_lock(uint32_t state) { return (state & WRITER) == 0 && readers(state) == 0; }
+        static constexpr bool can_lock_shared(uint32_t state) { return (state & (WRITER | WRITER_WAITING)) == 0; }
+        static constexpr bool can_lock_upgrade(uint32_t state) { return (state & (WRITER | UPGRADER | WRITER_WAITING)) == 0; }
+        static constexpr bool can_promote(uint32_t state) { return readers(state) == 1; }
+        static constexpr bool can_promote_shared(uint32_t state) { return readers(state) == 1 && (state & UPGRADER) == 0; }
+
+        //spins until can_acquire(state) is true and then replaces the state with acquire(state), the waiting bits are set while spinning
+        template<typename CanAcquire, typename Acquire>
+        void acquire(CanAcquire canAcquire, Acquire acquire, uint32_t waitingBits);
+        template<typename CanAcquire, typename Acquire>
+        bool try_acquire(CanAcquire canAcquire, Acquire acquire);
+
+        std::atomic<uint32_t> m_state{ 0 };
+    };
+    static_assert(sizeof(shared_spin_mutex) == detail::cache_line_size, "the shared_spin_mutex has to fit into one cache line");
+
+    inline void shared_spin_mutex::lock()
+    {
+        uint32_t state = 0;
+        if (!m_state.compare_exchange_strong(state, WRITER, std::memory_order_acquire, std::memory_order_relaxed))
+            acquire(can_lock, [](uint32_t current) { return (current & ~WRITER_WAITING) | WRITER; }, WRITER_WAITING);
+    }
+    inline void shared_spin_mutex::lock_shared()
+    {
+        uint32_t state = m_state.load(std::memory_order_relaxed);
+        if (!can_lock_shared(state) || !m_state.compare_exchange_weak(state, state + READER, std::memory_order_acquire, std::memory_order_relaxed))
+            acquire(can_lock_shared, [](uint32_t current) { return current + READER; }, 0);
+    }
+    inline void shared_spin_mutex::unlock()
+    {
+        m_state.fetch_and(~(WRITER | WRITER_WAITING), std::memory_order_release);
+    }
+    inline void shared_spin_mutex::unlock_shared()
+    {
+        m_state.fetch_sub(READER, std::memory_order_release);
+    }
+    inline bool shared_spin_mutex::try_lock()
+    {
+        return try_acquire(can_lock, [](uint32_t current) { return (current & ~WRITER_WAITING) | WRITER; });
+    }
+    inline bool shared_spin_mutex::try_lock_shared()
+    {
+        return try_acquire(can_lock_shared, [](uint32_t current) { return current + READER; });
+    }
+    inline void shared_spin_mutex::lock_upgrade()
+    {
+        acquire(can_lock_upgrade, [](uint32_t current) { return current + UPGRADER + READER; }, 0);
+    }
+    inline void shared_spin_mutex::unlock_upgrade()
+    {
+        m_state.fetch_sub(UPGRADER + READER, std::memory_order_release);
+    }
+    inline bool shared_spin_mutex::try_lock_upgrade()
+    {
+        return try_acquire(can_lock_upgrade, [](uint32_t current) { return current + UPGRADER + READER; });
+    }
+    inline void shared_spin_mutex::unlock_upgrade_and_lock()
+    {
+        //while we wait for the readers to leave we block new readers like any other waiting writer
+        acquire(can_promote, [](uint32_t current) { return ((current - UPGRADER - READER) & ~WRITER_WAITING) | WRITER; }, WRITER_WAITING);
+    }
+    inline bool shared_spin_mutex::try_unlock_upgrade_and_lock()
+    {
+        return try_acquire(can_promote, [](uint32_t current) { return ((current - UPGRADER - READER) & ~WRITER_WAITING) | WRITER; });
+    }
+    inline void shared_spin_mutex::unlock_and_lock_upgrade()
+    {
+        m_state.fetch_add(UPGRADER + READER - WRITER, std::memory_order_release);
+    }
+    inline void shared_spin_mutex::unlock_upgrade_and_lock_shared()
+    {
+        m_state.fetch_sub(UPGRADER, std::memory_order_release);
+    }
+    inline bool shared_spin_mutex::try_unlock_shared_and_lock()
+    {
+        return try_acquire(can_promote_shared, [](uint32_t current) { return ((current - READER) & ~WRITER_WAITING) | WRITER; });
+    }
+    inline void shared_spin_mutex::unlock_and_lock_shared()
+    {
+        m_state.fetch_add(READER - WRITER, std::memory_order_release);
+    }
+
+    template<typename CanAcquire, typename Acquire>
+    void shared_spin_mutex::acquire(CanAcquire canAcquire, Acquire acquire, uint32_t waitingBits)
+    {
+        detail::spin_backoff<> backoff;
+        uint32_t state = m_state.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (canAcquire(state))
+            {
+                if (m_state.compare_exchange_weak(state, acquire(state), std::memory_order_acquire, std::memory_order_relaxed))
+                    return;
+                continue;
+            }
+            //a waiting writer blocks new readers, the bit is cleared when a writer gets the lock or unlocks
+            if ((state & waitingBits) != waitingBits)
+                m_state.fetch_or(waitingBits, std::memory_order_relaxed);
+            backoff.pause();
+            state = m_state.load(std::memory_order_relaxed);
+        }
+    }
+    template<typename CanAcquire, typename Acquire>
+    bool shared_spin_mutex::try_acquire(CanAcquire canAcquire, Acquire acquire)
+    {
+        uint32_t state = m_state.load(std::memory_order_relaxed);
+        while (canAcquire(state))
+        {
+            if (m_state.compare_exchange_weak(state, acquire(state), std::memory_order_acquire, std::memory_order_relaxed))
+                return true;
+        }
+        return false;
+    }
+
+    /**
+    * @brief shared_recursive_mutex_t variant that never enters the kernel, for threads that are pinned to isolated cores
+    */
+    template<typename PhantomType>
+    using shared_recursive_spin_mutex_t = shared_recursive_mutex_t<PhantomType, shared_spin_mutex>;
+}
@@ -0,0 +1,138 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <utility>
+
+namespace mtx
+{
+    /**
+    * @brief Movable RAII wrapper for upgradeable ownership, works like std::shared_lock but calls lock_upgradeable/unlock_upgradeable.
+    */
+    template<typename Mutex>
+    class upgrade_lock {
+    public:
+        using mutex_type = Mutex;
+
+        upgrade_lock() noexcept = default;
+        explicit upgrade_lock(mutex_type& mutex)
+            : m_mutex(std::addressof(mutex))
+        {
+            m_mutex->lock_upgradeable();
+            m_ownsLock = true;
+        }
+        upgrade_lock(mutex_type& mutex, std::defer_lock_t) noexcept
+            : m_mutex(std::addressof(mutex))
+        {
+        }
+        upgrade_lock(mutex_type& mutex, std::try_to_lock_t)
+            : m_mutex(std::addressof(mutex))
+            , m_ownsLock(mutex.try_lock_upgradeable())
+        {
+        }
+        upgrade_lock(mutex_type& mutex, std::adopt_lock_t) noexcept
+            : m_mutex(std::addressof(mutex))
+            , m_ownsLock(true)
+        {
+        }
+        ~upgrade_lock()
+        {
+            if (m_ownsLock)
+                m_mutex->unlock_upgradeable();
+        }
+
+        upgrade_lock(const upgrade_lock&) = delete;
+        upgrade_lock& operator =(const upgrade_lock&) = delete;
+        upgrade_lock(upgrade_lock&& other) noexcept
+            : m_mutex(std::exchange(other.m_mutex, nullptr))
+            , m_ownsLock(std::exchange(other.m_ownsLock, false))
+        {
+        }
+        upgrade_lock& operator =(upgrade_lock&& other) noexcept
+        {
+            upgrade_lock(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        void lock()
+        {
+            check_lockable();
+            m_mutex->lock_upgradeable();
+            m_ownsLock = true;
+        }
+        [[nodiscard]] bool try_lock()
+        {
+            check_lockable();
+            m_ownsLock = m_mutex->try_lock_upgradeable();
+            return m_ownsLock;
+        }
+        void unlock()
+        {
+            if (!m_ownsLock)
+                throw std::system_error(std::make_error_code(std::errc::operation_not_permitted));
+            m_mutex->unlock_upgradeable();
+            m_ownsLock = false;
+        }
+
+        void swap(upgrade_lock& other) noexcept
+        {
+            std::swap(m_mutex, other.m_mutex);
+            std::swap(m_ownsLock, other.m_ownsLock);
+        }
+        mutex_type* release() noexcept
+        {
+            m_ownsLock = false;
+            return std::exchange(m_mutex, nullptr);
+        }
+
+        [[nodiscard]] bool owns_lock() const noexcept { return m_ownsLock; }
+        explicit operator bool() const noexcept { return m_ownsLock; }
+        [[nodiscard]] mutex_type* mutex() const noexcept { return m_mutex; }
+
+    private:
+        void check_lockable() const
+        {
+            if (m_mutex == nullptr)
+                throw std::system_error(std::make_error_code(std::errc::operation_not_permitted));
+            if (m_ownsLock)
+                throw std::system_error(std::make_error_code(std::errc::resource_deadlock_would_occur));
+        }
+
+        mutex_type* m_mutex = nullptr;
+        bool m_ownsLock = false;
+    };
+
+    /**
+    * @brief Promotes the upgradeable ownership of an upgrade_lock to write ownership for its lifetime.
+    */
+    //for the shared recursive mutexes this is the same as a std::unique_lock while holding the upgrade_lock,
+    //it exists to make the intent explicit and to make sure the upgrade_lock really owns the mutex
+    template<typename Mutex>
+    class upgrade_to_unique_lock {
+    public:
+        using mutex_type = Mutex;
+
+        explicit upgrade_to_unique_lock(upgrade_lock<Mutex>& upgradeLock)
+            : m_mutex(upgradeLock.mutex())
+        {
+            if (!upgradeLock.owns_lock())
+                throw std::system_error(std::make_error_code(std::errc::operation_not_permitted));
+            m_mutex->lock();
+        }
+        ~upgrade_to_unique_lock()
+        {
+            m_mutex->unlock();
+        }
+
+        upgrade_to_unique_lock(const upgrade_to_unique_lock&) = delete;
+        upgrade_to_unique_lock& operator =(const upgrade_to_unique_lock&) = delete;
+
+        [[nodiscard]] mutex_type* mutex() const noexcept { return m_mutex; }
+
+    private:
+        mutex_type* m_mutex;
+    };
+}
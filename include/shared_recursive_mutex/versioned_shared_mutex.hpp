@@ -0,0 +1,93 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/shared_futex_mutex.hpp>
+#include <shared_recursive_mutex/detail/cache_line.hpp>
+#include <atomic>
+#include <cstdint>
+
+namespace mtx
+{
+    /**
+    * @brief Adds a version counter (seqlock) to a Backend, so readers can read optimistically without writing to shared memory.
+    */
+    //writers increment the version when they get the lock (it becomes odd) and when they release it (even again), readers
+    //remember the version before they read and check afterwards that it didn't change. Readers that fail too often
+    //(MaxFailedValidations times in a row) take a real read lock, so they can't starve. The recursion layer drives this
+    //with read_begin/read_validate, the normal read locks are passed through to the Backend.
+    template<typename Backend = shared_futex_mutex, uint32_t MaxFailedValidations = 4>
+    class versioned_shared_mutex {
+    public:
+        static constexpr uint32_t max_failed_validations = MaxFailedValidations;
+
+        versioned_shared_mutex() = default;
+        /**
+        * @brief Copying the mutex is not allowed
+        */
+        versioned_shared_mutex(const versioned_shared_mutex&) = delete;
+        versioned_shared_mutex& operator =(const versioned_shared_mutex&) = delete;
+
+        void lock()
+        {
+            m_backend.lock();
+            begin_write();
+        }
+        void lock_shared() { m_backend.lock_shared(); }
+        void unlock()
+        {
+            end_write();
+            m_backend.unlock();
+        }
+        void unlock_shared() { m_backend.unlock_shared(); }
+        [[nodiscard]] bool try_lock()
+        {
+            if (!m_backend.try_lock())
+                return false;
+            begin_write();
+            return true;
+        }
+        [[nodiscard]] bool try_lock_shared() { return m_backend.try_lock_shared(); }
+
+        /**
+        * @brief Returns the current version, it's odd while a writer owns the mutex.
+        */
+        [[nodiscard]] uint64_t read_begin() const
+        {
+            return m_version.load(std::memory_order_acquire);
+        }
+        /**
+        * @brief Returns true if no writer got the mutex since read_begin returned the (even) version.
+        */
+        [[nodiscard]] bool read_validate(uint64_t version) const
+        {
+            //the loads of the reader can't move below the fence
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return m_version.load(std::memory_order_relaxed) == version;
+        }
+
+    private:
+        //the version is only changed while the backend is locked exclusively
+        void begin_write()
+        {
+            m_version.store(m_version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            //the stores of the writer can't move above the fence
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        void end_write()
+        {
+            m_version.store(m_version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        Backend m_backend;
+        //only written by writers, optimistic readers only read this cache line
+        alignas(detail::cache_line_size) std::atomic<uint64_t> m_version{ 0 };
+    };
+
+    /**
+    * @brief shared_recursive_mutex_t variant with optimistic reads (read_begin/read_validate)
+    */
+    template<typename PhantomType>
+    using shared_recursive_versioned_mutex_t = shared_recursive_mutex_t<PhantomType, versioned_shared_mutex<>>;
+}
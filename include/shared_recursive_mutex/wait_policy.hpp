@@ -0,0 +1,99 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#pragma once
+#include <shared_recursive_mutex/detail/spin.hpp>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace mtx
+{
+    //a wait policy decides what a thread does before it parks on a contended lock (basic_shared_futex_mutex<WaitPolicy>).
+    //it has to provide:
+    //  template<typename Ready> void spin(Ready ready)  - is called once before the thread parks for the first time, may return as soon as ready() is true
+    //  void acquired(bool parked)                        - is called after a contended acquisition, parked is true if the thread had to park
+    //the lock derives from the policy, so a policy without state doesn't make the lock bigger.
+
+    /**
+    * @brief Parks contended threads right away, this is the best choice if the critical sections are long or the machine is oversubscribed.
+    */
+    struct park_wait_policy
+    {
+        template<typename Ready>
+        void spin(Ready) {}
+        void acquired(bool) {}
+    };
+
+    /**
+    * @brief Number of contended acquisitions of a lock that were satisfied by spinning and by parking.
+    */
+    struct wait_statistics
+    {
+        uint64_t spinAcquisitions = 0;
+        uint64_t parkAcquisitions = 0;
+    };
+
+    namespace detail
+    {
+        //there is no portable way to find out if the owner of a lock is running, but if every cpu is busy spinning
+        //it can't be, so spinning threads are counted and compared with the number of cpus
+        inline uint32_t max_spinners()
+        {
+            //one cpu is left for the owner of the lock
+            static const uint32_t maxSpinners = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0;
+            return maxSpinners;
+        }
+    }
+
+    /**
+    * @brief Spins with exponential backoff (up to MaxSpins pause instructions in a row) before a contended thread parks.
+    *        Avoids the syscalls and the wakeup latency of parking for short critical sections.
+    */
+    //stops spinning early (or doesn't spin at all) if so many threads spin on the lock that its owner most likely doesn't get a cpu.
+    //the spinners are counted per lock, a process wide counter would be a cache line that every contended acquisition of every lock writes to
+    template<uint32_t MaxSpins = 1024>
+    class adaptive_spin_wait_policy {
+    public:
+        template<typename Ready>
+        void spin(Ready ready);
+        void acquired(bool parked);
+
+        /**
+        * @brief Returns how many contended acquisitions were satisfied by spinning and how many had to park.
+        */
+        [[nodiscard]] wait_statistics statistics() const;
+
+    private:
+        std::atomic<uint64_t> m_spinAcquisitions{ 0 };
+        std::atomic<uint64_t> m_parkAcquisitions{ 0 };
+        std::atomic<uint32_t> m_spinners{ 0 };
+    };
+
+    template<uint32_t MaxSpins>
+    template<typename Ready>
+    void adaptive_spin_wait_policy<MaxSpins>::spin(Ready ready)
+    {
+        if (m_spinners.fetch_add(1, std::memory_order_relaxed) < detail::max_spinners())
+        {
+            detail::backoff<MaxSpins> wait;
+            while (wait.spinning() && !ready())
+            {
+                wait.pause();
+                if (m_spinners.load(std::memory_order_relaxed) > detail::max_spinners())
+                    break;
+            }
+        }
+        m_spinners.fetch_sub(1, std::memory_order_relaxed);
+    }
+    template<uint32_t MaxSpins>
+    void adaptive_spin_wait_policy<MaxSpins>::acquired(bool parked)
+    {
+        (parked ? m_parkAcquisitions : m_spinAcquisitions).fetch_add(1, std::memory_order_relaxed);
+    }
+    template<uint32_t MaxSpins>
+    wait_statistics adaptive_spin_wait_policy<MaxSpins>::statistics() const
+    {
+        return { m_spinAcquisitions.load(std::memory_order_relaxed), m_parkAcquisitions.load(std::memory_order_relaxed) };
+    }
+}
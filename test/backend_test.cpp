@@ -0,0 +1,99 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/pthread_shared_mutex.hpp>
+#include <shared_recursive_mutex/distributed_shared_mutex.hpp>
+#include <shared_recursive_mutex/queued_shared_mutex.hpp>
+#include <shared_recursive_mutex/cohort_shared_mutex.hpp>
+#include <shared_recursive_mutex/bravo_shared_mutex.hpp>
+#include <shared_recursive_mutex/membarrier_shared_mutex.hpp>
+#include <shared_recursive_mutex/phase_fair_ticket_mutex.hpp>
+#include <shared_recursive_mutex/shared_spin_mutex.hpp>
+#include <shared_recursive_mutex/versioned_shared_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <array>
+#include <future>
+
+template<typename Backend>
+class shared_recursive_mutex_backend : public ::testing::Test
+{
+public:
+	using mutex_type = mtx::shared_recursive_mutex_t<struct BackendTestType, Backend>;
+};
+
+using Backends = ::testing::Types<
+	mtx::shared_futex_mutex,
+	mtx::basic_shared_futex_mutex<mtx::park_wait_policy, mtx::lock_fairness::reader_preferring>,
+	mtx::basic_shared_futex_mutex<mtx::park_wait_policy, mtx::lock_fairness::phase_fair>,
+	std::shared_mutex,
+	std::shared_timed_mutex,
+	mtx::distributed_shared_mutex<>,
+	mtx::distributed_shared_mutex<mtx::percpu_reader_indicator>,
+	mtx::distributed_shared_mutex<mtx::snzi_reader_indicator<>>,
+	mtx::queued_shared_mutex,
+	mtx::cohort_shared_mutex<>,
+	mtx::bravo_shared_mutex<>,
+	mtx::membarrier_shared_mutex,
+	mtx::phase_fair_ticket_mutex,
+	mtx::shared_spin_mutex,
+	mtx::versioned_shared_mutex<>
+#if defined(SHARED_RECURSIVE_MUTEX_HAS_PTHREAD)
+	, mtx::pthread_shared_mutex<>
+#endif
+#if defined(__GLIBC__)
+	, mtx::pthread_shared_mutex<mtx::pthread_rwlock_preference::prefer_writer_nonrecursive>
+#endif
+>;
+TYPED_TEST_SUITE(shared_recursive_mutex_backend, Backends);
+
+TYPED_TEST(shared_recursive_mutex_backend, recursive_ownership)
+{
+	auto& mutex = TestFixture::mutex_type::instance();
+	{
+		std::shared_lock read_guard(mutex);
+		std::shared_lock read_guard2(mutex);
+		EXPECT_TRUE(mutex.is_locked_shared());
+		{
+			std::unique_lock write_guard(mutex);
+			std::unique_lock write_guard2(mutex);
+			EXPECT_TRUE(mutex.is_locked());
+		}
+		EXPECT_TRUE(mutex.is_locked_shared());
+		std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock()); }).get();
+	}
+	EXPECT_FALSE(mutex.is_locked_shared());
+	EXPECT_FALSE(mutex.is_locked());
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock());
+		mutex.unlock();
+	}).get();
+}
+
+TYPED_TEST(shared_recursive_mutex_backend, read_guard_before_write)
+{
+	constexpr int numThreads = 8;
+	constexpr int numIterations = 1000;
+	auto& mutex = TestFixture::mutex_type::instance();
+	int counter = 0;
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				std::shared_lock read_guard(mutex);
+				std::shared_lock read_guard2(mutex);
+				std::unique_lock write_guard(mutex);
+				counter++;
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	ASSERT_EQ(counter, numThreads * numIterations);
+}
@@ -0,0 +1,105 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/bravo_shared_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST(bravo_shared_mutex, writer_revokes_bias)
+{
+	mtx::bravo_shared_mutex<> mutex;
+	EXPECT_TRUE(mutex.is_read_biased());
+	mutex.lock_shared();
+	std::atomic<bool> written{ false };
+	auto writer = std::async(std::launch::async, [&]() {
+		EXPECT_FALSE(mutex.try_lock());
+		std::unique_lock lock(mutex);
+		written = true;
+	});
+	std::this_thread::sleep_for(20ms);
+	EXPECT_FALSE(written);
+	mutex.unlock_shared();
+	writer.get();
+	EXPECT_TRUE(written);
+	EXPECT_FALSE(mutex.is_read_biased());
+}
+
+TEST(bravo_shared_mutex, slow_reader_enables_bias_again)
+{
+	//without inhibition the next reader on the slow path restores the bias immediately
+	mtx::bravo_shared_mutex<mtx::shared_futex_mutex, 0> mutex;
+	mutex.lock();
+	mutex.unlock();
+	EXPECT_FALSE(mutex.is_read_biased());
+	mutex.lock_shared();
+	EXPECT_TRUE(mutex.is_read_biased());
+	//a second read lock of the same thread uses the table, both releases have to find their way back
+	mutex.lock_shared();
+	mutex.unlock_shared();
+	mutex.unlock_shared();
+	EXPECT_TRUE(mutex.try_lock());
+	mutex.unlock();
+}
+
+TEST(bravo_shared_mutex, many_biased_reads_of_one_thread)
+{
+	//every read lock either takes a slot of the table or the backend, the releases have to find their way back in any order
+	std::vector<std::unique_ptr<mtx::bravo_shared_mutex<>>> mutexes(500);
+	for (auto& mutex : mutexes)
+		mutex = std::make_unique<mtx::bravo_shared_mutex<>>();
+	for (auto& mutex : mutexes)
+		mutex->lock_shared();
+	std::async(std::launch::async, [&]() {
+		for (auto& mutex : mutexes)
+			EXPECT_FALSE(mutex->try_lock());
+	}).get();
+	for (auto it = mutexes.rbegin(); it != mutexes.rend(); ++it)
+		(*it)->unlock_shared();
+	std::async(std::launch::async, [&]() {
+		for (auto& mutex : mutexes)
+		{
+			EXPECT_TRUE(mutex->try_lock());
+			mutex->unlock();
+		}
+	}).get();
+}
+
+TEST(bravo_shared_mutex, concurrent_counter)
+{
+	constexpr int numThreads = 8;
+	constexpr int numIterations = 5000;
+	auto& mutex = mtx::shared_recursive_bravo_mutex_t<struct BravoTestType>::instance();
+	int counter = 0;
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				std::shared_lock read_guard(mutex);
+				const int before = counter;
+				std::shared_lock read_guard2(mutex);
+				ASSERT_EQ(before, counter);
+				if (i % 64 == 0)
+				{
+					std::unique_lock write_guard(mutex);
+					counter++;
+				}
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	ASSERT_EQ(counter, numThreads * ((numIterations + 63) / 64));
+}
@@ -0,0 +1,72 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/cohort_shared_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <array>
+#include <future>
+
+TEST(cohort_shared_mutex, parse_id_list)
+{
+	EXPECT_EQ(mtx::detail::parse_id_list("0\n"), 1u);
+	EXPECT_EQ(mtx::detail::parse_id_list("0-1\n"), 2u);
+	EXPECT_EQ(mtx::detail::parse_id_list("0-3,8-11"), 12u);
+	EXPECT_EQ(mtx::detail::parse_id_list(""), 0u);
+	EXPECT_EQ(mtx::detail::parse_id_list("x"), 0u);
+	EXPECT_GE(mtx::detail::numa_node_count(), 1u);
+}
+
+TEST(cohort_shared_mutex, exclusive_excludes_everyone)
+{
+	mtx::cohort_shared_mutex<> mutex;
+	mutex.lock();
+	std::async(std::launch::async, [&]() {
+		EXPECT_FALSE(mutex.try_lock());
+		EXPECT_FALSE(mutex.try_lock_shared());
+	}).get();
+	mutex.unlock();
+	mutex.lock_shared();
+	std::async(std::launch::async, [&]() {
+		EXPECT_FALSE(mutex.try_lock());
+		EXPECT_TRUE(mutex.try_lock_shared());
+		mutex.unlock_shared();
+	}).get();
+	mutex.unlock_shared();
+	EXPECT_TRUE(mutex.try_lock());
+	mutex.unlock();
+}
+
+TEST(cohort_shared_mutex, batched_handover)
+{
+	constexpr int numThreads = 8;
+	constexpr int numIterations = 5000;
+	//a small batch bound makes the global lock change hands often
+	auto& mutex = mtx::shared_recursive_mutex_t<struct CohortTestType, mtx::cohort_shared_mutex<2, 3>>::instance();
+	int counter = 0;
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				if (i % 4 == 0)
+				{
+					std::shared_lock read_guard(mutex);
+					ASSERT_GE(counter, 0);
+				}
+				else
+				{
+					std::unique_lock write_guard(mutex);
+					counter++;
+				}
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	ASSERT_EQ(counter, numThreads * (numIterations - numIterations / 4));
+}
@@ -0,0 +1,90 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <future>
+
+using namespace std::chrono_literals;
+
+TEST(combine, runs_closure_with_write_ownership)
+{
+	mtx::shared_recursive_mutex mutex;
+	int counter = 0;
+	mutex.combine([&]() {
+		EXPECT_TRUE(mutex.is_locked());
+		++counter;
+	});
+	EXPECT_EQ(counter, 1);
+	EXPECT_FALSE(mutex.is_locked());
+	{
+		std::shared_lock read_guard(mutex);
+		mutex.combine([&]() { ++counter; });
+		//the read ownership is back
+		EXPECT_TRUE(mutex.is_locked_shared());
+	}
+	{
+		std::unique_lock write_guard(mutex);
+		//runs right away, we already own the mutex
+		mutex.combine([&]() { ++counter; });
+		EXPECT_EQ(counter, 3);
+	}
+	std::async(std::launch::async, [&]() { EXPECT_TRUE(mutex.try_lock()); mutex.unlock(); }).get();
+}
+
+TEST(combine, lock_holder_runs_published_closures)
+{
+	mtx::shared_recursive_mutex mutex;
+	std::thread::id executedBy;
+	std::unique_lock write_guard(mutex);
+	auto waiter = std::async(std::launch::async, [&]() {
+		mutex.combine([&]() { executedBy = std::this_thread::get_id(); });
+	});
+	EXPECT_EQ(waiter.wait_for(20ms), std::future_status::timeout);
+	//the closure is executed before the write ownership is released
+	write_guard.unlock();
+	EXPECT_EQ(executedBy, std::this_thread::get_id());
+	waiter.get();
+}
+
+TEST(combine, exceptions_are_rethrown_in_the_submitting_thread)
+{
+	mtx::shared_recursive_mutex mutex;
+	std::unique_lock write_guard(mutex);
+	auto waiter = std::async(std::launch::async, [&]() {
+		mutex.combine([]() { throw std::runtime_error("combined"); });
+	});
+	EXPECT_EQ(waiter.wait_for(20ms), std::future_status::timeout);
+	write_guard.unlock();
+	EXPECT_THROW(waiter.get(), std::runtime_error);
+	EXPECT_TRUE(mutex.try_lock());
+	mutex.unlock();
+}
+
+TEST(combine, concurrent_readers_combine_writes)
+{
+	auto& mutex = mtx::shared_recursive_mutex_t<struct CombineStressType>::instance();
+	uint64_t counter = 0;
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 8; ++i)
+	{
+		threads.emplace_back([&]() {
+			for (int j = 0; j < 2000; ++j)
+			{
+				std::shared_lock read_guard(mutex);
+				if (j % 20 == 0)
+					mutex.combine([&]() { ++counter; });
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	EXPECT_EQ(counter, 8u * 100u);
+}
@@ -0,0 +1,71 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/compact_shared_recursive_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <array>
+#include <vector>
+#include <future>
+
+TEST(compact_shared_recursive_mutex, recursion_and_upgrade)
+{
+	mtx::compact_shared_recursive_mutex mutex;
+	std::shared_lock read_guard(mutex);
+	{
+		std::shared_lock nested_read(mutex);
+		//the read lock is given up and reacquired, like with the other shared recursive mutexes
+		std::unique_lock write_guard(mutex);
+		std::unique_lock nested_write(mutex);
+		EXPECT_TRUE(mutex.is_locked());
+		std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock_shared()); }).get();
+	}
+	EXPECT_TRUE(mutex.is_locked_shared());
+	std::async(std::launch::async, [&]() {
+		EXPECT_FALSE(mutex.try_lock());
+		EXPECT_TRUE(mutex.try_lock_shared());
+		mutex.unlock_shared();
+	}).get();
+}
+
+TEST(compact_shared_recursive_mutex, one_lock_per_object)
+{
+	struct entry
+	{
+		mtx::compact_shared_recursive_mutex mutex;
+		uint32_t value = 0;
+	};
+	static_assert(sizeof(entry) == 8, "the lock only adds 4 bytes to the entry");
+	std::vector<entry> entries(1000);
+	//neighbouring mutexes are independent, a thread can hold many of them
+	for (auto& current : entries)
+		current.mutex.lock_shared();
+	std::async(std::launch::async, [&]() {
+		for (auto& current : entries)
+			EXPECT_FALSE(current.mutex.try_lock());
+	}).get();
+	for (auto& current : entries)
+		current.mutex.unlock_shared();
+
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		threads.emplace_back([&, i]() {
+			for (uint32_t j = 0; j < 20000; ++j)
+			{
+				auto& current = entries[(j * 7 + i) % entries.size()];
+				std::shared_lock read_guard(current.mutex);
+				std::unique_lock write_guard(current.mutex);
+				++current.value;
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	uint32_t sum = 0;
+	for (auto& current : entries)
+		sum += current.value;
+	EXPECT_EQ(sum, 4u * 20000u);
+}
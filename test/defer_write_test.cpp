@@ -0,0 +1,104 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <shared_recursive_mutex/deferred_write_drainer.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+
+using namespace std::chrono_literals;
+
+TEST(defer_write, next_writer_runs_queued_writes)
+{
+	mtx::shared_recursive_mutex mutex;
+	std::vector<int> values;
+	{
+		std::shared_lock read_guard(mutex);
+		mutex.defer_write([&]() { values.push_back(1); });
+		mutex.defer_write([&]() { values.push_back(2); });
+		//the reader keeps its read ownership and nothing ran yet
+		EXPECT_TRUE(mutex.is_locked_shared());
+		EXPECT_TRUE(values.empty());
+	}
+	std::async(std::launch::async, [&]() { std::unique_lock write_guard(mutex); }).get();
+	EXPECT_EQ(values, (std::vector<int>{ 1, 2 }));
+	{
+		std::unique_lock write_guard(mutex);
+		//a writer runs it right away
+		mutex.defer_write([&]() { values.push_back(3); });
+		EXPECT_EQ(values.size(), 3u);
+	}
+}
+
+TEST(defer_write, drain_and_drainer)
+{
+	mtx::shared_recursive_mutex mutex;
+	int counter = 0;
+	mutex.defer_write([&]() { EXPECT_TRUE(mutex.is_locked()); ++counter; });
+	mutex.drain_deferred_writes();
+	EXPECT_EQ(counter, 1);
+	EXPECT_FALSE(mutex.is_locked());
+
+	std::atomic<bool> drained{ false };
+	{
+		mtx::deferred_write_drainer drainer(mutex, 1ms);
+		mutex.defer_write([&]() { drained = true; });
+		const auto deadline = std::chrono::steady_clock::now() + 5s;
+		while (!drained && std::chrono::steady_clock::now() < deadline)
+			std::this_thread::sleep_for(1ms);
+		EXPECT_TRUE(drained);
+	}
+	//the drainer drains once more when it stops
+	{
+		mtx::deferred_write_drainer drainer(mutex, 1h);
+		mutex.defer_write([&]() { ++counter; });
+	}
+	EXPECT_EQ(counter, 2);
+}
+
+TEST(defer_write, destroyed_mutex_discards_queued_writes)
+{
+	auto resource = std::make_shared<int>(0);
+	{
+		mtx::shared_recursive_mutex mutex;
+		mutex.defer_write([resource]() { ++*resource; });
+		EXPECT_EQ(resource.use_count(), 2);
+	}
+	EXPECT_EQ(resource.use_count(), 1);
+	EXPECT_EQ(*resource, 0);
+}
+
+TEST(defer_write, concurrent_readers_defer_writes)
+{
+	auto& mutex = mtx::shared_recursive_mutex_t<struct DeferStressType>::instance();
+	uint64_t counter = 0;
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 8; ++i)
+	{
+		threads.emplace_back([&, i]() {
+			for (int j = 0; j < 2000; ++j)
+			{
+				if (i == 0 && j % 100 == 0)
+				{
+					std::unique_lock write_guard(mutex);
+					continue;
+				}
+				std::shared_lock read_guard(mutex);
+				if (j % 10 == 0)
+					mutex.defer_write([&]() { ++counter; });
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	mutex.drain_deferred_writes();
+	std::shared_lock read_guard(mutex);
+	EXPECT_EQ(counter, 7u * 200u + 180u);
+}
@@ -0,0 +1,173 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/distributed_shared_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <array>
+#include <atomic>
+#include <future>
+
+TEST(distributed_shared_mutex, writer_drains_readers)
+{
+	mtx::distributed_shared_mutex<mtx::slotted_reader_indicator<4>> mutex;
+	std::atomic<bool> writerDone{ false };
+	mutex.lock_shared();
+	auto writer = std::async(std::launch::async, [&]() {
+		std::unique_lock lock(mutex);
+		writerDone = true;
+	});
+	//the writer has set its flag as soon as new readers are turned away
+	while (mutex.try_lock_shared())
+	{
+		mutex.unlock_shared();
+		std::this_thread::yield();
+	}
+	EXPECT_FALSE(writerDone);
+	mutex.unlock_shared();
+	writer.get();
+	EXPECT_TRUE(writerDone);
+	EXPECT_TRUE(mutex.try_lock_shared());
+	mutex.unlock_shared();
+}
+
+TEST(distributed_shared_mutex, more_threads_than_slots)
+{
+	constexpr int numThreads = 12;
+	constexpr int numIterations = 2000;
+	auto& mutex = mtx::shared_recursive_mutex_t<struct DistributedTestType, mtx::distributed_shared_mutex<mtx::slotted_reader_indicator<4>>>::instance();
+	int counter = 0;
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				std::shared_lock read_guard(mutex);
+				std::shared_lock read_guard2(mutex);
+				if (i % 10 == 0)
+				{
+					std::unique_lock write_guard(mutex);
+					counter++;
+				}
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	ASSERT_EQ(counter, numThreads * numIterations / 10);
+}
+
+TEST(distributed_shared_mutex, percpu_counters_survive_migration)
+{
+	mtx::percpu_reader_indicator readers;
+	EXPECT_TRUE(readers.empty());
+	readers.arrive();
+	readers.arrive();
+	EXPECT_FALSE(readers.empty());
+	//a reader that migrated departs on another cpu, the sums still have to match
+	std::async(std::launch::async, [&]() { readers.depart(); }).get();
+	EXPECT_FALSE(readers.empty());
+	readers.depart();
+	EXPECT_TRUE(readers.empty());
+	//cpus that don't fit into the counters are reported to the caller
+	std::atomic<uint64_t> counter{ 0 };
+	EXPECT_FALSE(mtx::detail::rseq_add_on_cpu(&counter, 0, 1));
+	EXPECT_EQ(counter.load(), 0u);
+}
+
+TEST(distributed_shared_mutex, percpu_counters)
+{
+	constexpr int numThreads = 12;
+	constexpr int numIterations = 2000;
+	auto& mutex = mtx::shared_recursive_mutex_t<struct PercpuTestType, mtx::distributed_shared_mutex<mtx::percpu_reader_indicator>>::instance();
+	int counter = 0;
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				std::shared_lock read_guard(mutex);
+				const int before = counter;
+				std::this_thread::yield();
+				ASSERT_EQ(before, counter);
+				if (i % 10 == 0)
+				{
+					std::unique_lock write_guard(mutex);
+					counter++;
+				}
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	ASSERT_EQ(counter, numThreads * numIterations / 10);
+}
+
+TEST(distributed_shared_mutex, snzi_tracks_presence)
+{
+	mtx::snzi_reader_indicator<16, 2> readers;
+	EXPECT_TRUE(readers.empty());
+	readers.arrive();
+	readers.arrive();
+	EXPECT_FALSE(readers.empty());
+	readers.depart();
+	EXPECT_FALSE(readers.empty());
+	readers.depart();
+	EXPECT_TRUE(readers.empty());
+	//every thread departs from the leaf it arrived at, while one of them is inside the root has to be non zero
+	constexpr int numThreads = 8;
+	std::atomic<bool> violated{ false };
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < 2000; ++i)
+			{
+				readers.arrive();
+				if (readers.empty())
+					violated = true;
+				readers.depart();
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+	EXPECT_FALSE(violated);
+	EXPECT_TRUE(readers.empty());
+}
+
+TEST(distributed_shared_mutex, snzi_counter)
+{
+	constexpr int numThreads = 12;
+	constexpr int numIterations = 2000;
+	auto& mutex = mtx::shared_recursive_mutex_t<struct SnziTestType, mtx::distributed_shared_mutex<mtx::snzi_reader_indicator<>>>::instance();
+	int counter = 0;
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				std::shared_lock read_guard(mutex);
+				const int before = counter;
+				std::this_thread::yield();
+				ASSERT_EQ(before, counter);
+				if (i % 10 == 0)
+				{
+					std::unique_lock write_guard(mutex);
+					counter++;
+				}
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	ASSERT_EQ(counter, numThreads * numIterations / 10);
+}
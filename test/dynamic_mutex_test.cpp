@@ -0,0 +1,148 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <memory>
+#include <array>
+#include <vector>
+#include <future>
+
+TEST(shared_recursive_mutex, instances_are_independent)
+{
+	mtx::shared_recursive_mutex first;
+	mtx::shared_recursive_mutex second;
+	std::shared_lock read_guard(first);
+	EXPECT_TRUE(first.is_locked_shared());
+	EXPECT_FALSE(second.is_locked_shared());
+	{
+		std::unique_lock write_guard(second);
+		std::shared_lock read_guard2(second);
+		EXPECT_TRUE(second.is_locked());
+		EXPECT_FALSE(first.is_locked());
+		EXPECT_TRUE(first.is_locked_shared());
+	}
+	EXPECT_FALSE(second.is_locked());
+	std::async(std::launch::async, [&]() {
+		EXPECT_FALSE(first.try_lock());
+		EXPECT_TRUE(second.try_lock());
+		second.unlock();
+	}).get();
+}
+
+TEST(shared_recursive_mutex, more_locks_than_table_entries)
+{
+	//holding more mutexes than the thread local table has entries uses the overflow entries
+	std::vector<std::unique_ptr<mtx::shared_recursive_mutex>> mutexes(40);
+	for (auto& mutex : mutexes)
+		mutex = std::make_unique<mtx::shared_recursive_mutex>();
+	for (auto& mutex : mutexes)
+	{
+		mutex->lock_shared();
+		mutex->lock_shared();
+	}
+	for (auto& mutex : mutexes)
+	{
+		mutex->lock();
+		EXPECT_TRUE(mutex->is_locked());
+	}
+	for (auto& mutex : mutexes)
+	{
+		mutex->unlock();
+		EXPECT_TRUE(mutex->is_locked_shared());
+		mutex->unlock_shared();
+	}
+	std::async(std::launch::async, [&]() {
+		for (auto& mutex : mutexes)
+			EXPECT_FALSE(mutex->try_lock());
+	}).get();
+	for (auto& mutex : mutexes)
+	{
+		mutex->unlock_shared();
+		EXPECT_FALSE(mutex->is_locked_shared());
+	}
+	std::async(std::launch::async, [&]() {
+		for (auto& mutex : mutexes)
+		{
+			EXPECT_TRUE(mutex->try_lock());
+			mutex->unlock();
+		}
+	}).get();
+}
+
+TEST(shared_recursive_mutex, overflow_is_given_back)
+{
+	std::vector<std::unique_ptr<mtx::shared_recursive_mutex>> mutexes(40);
+	for (auto& mutex : mutexes)
+		mutex = std::make_unique<mtx::shared_recursive_mutex>();
+	std::async(std::launch::async, [&]() {
+		for (int round = 0; round < 3; ++round)
+		{
+			//every round overflows the table and releases all mutexes again, which gives the overflow entries back
+			for (auto& mutex : mutexes)
+				mutex->lock_shared();
+			for (auto& mutex : mutexes)
+			{
+				mutex->lock_shared();
+				EXPECT_TRUE(mutex->is_locked_shared());
+			}
+			for (auto& mutex : mutexes)
+			{
+				mutex->unlock_shared();
+				mutex->unlock_shared();
+				EXPECT_FALSE(mutex->is_locked_shared());
+			}
+			//only a few mutexes, they fit into the table
+			for (std::size_t i = 0; i < 4; ++i)
+			{
+				std::unique_lock write_guard(*mutexes[i]);
+				std::shared_lock read_guard(*mutexes[i]);
+				EXPECT_TRUE(mutexes[i]->is_locked());
+			}
+		}
+	}).get();
+	for (auto& mutex : mutexes)
+	{
+		EXPECT_TRUE(mutex->try_lock());
+		mutex->unlock();
+	}
+}
+
+TEST(shared_recursive_mutex, per_shard_locks)
+{
+	constexpr int numThreads = 8;
+	constexpr int numShards = 32;
+	constexpr int numIterations = 2000;
+	std::array<mtx::shared_recursive_mutex, numShards> mutexes;
+	std::array<int, numShards> counters{};
+	std::array<std::future<void>, numThreads> threads;
+	for (int t = 0; t < numThreads; ++t)
+	{
+		threads[t] = std::async(std::launch::async, [&, t]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				const int shard = (i * 7 + t) % numShards;
+				const int otherShard = (i * 13 + t) % numShards;
+				//the shards are locked in the order of their index, otherwise two threads could deadlock
+				std::shared_lock other_read_guard(mutexes[otherShard], std::defer_lock);
+				if (otherShard < shard)
+					other_read_guard.lock();
+				std::shared_lock read_guard(mutexes[shard]);
+				std::unique_lock write_guard(mutexes[shard]);
+				if (otherShard >= shard)
+					other_read_guard.lock();
+				counters[shard]++;
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	int sum = 0;
+	for (int counter : counters)
+		sum += counter;
+	ASSERT_EQ(sum, numThreads * numIterations);
+}
@@ -0,0 +1,192 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/shared_futex_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+template<mtx::lock_fairness Fairness>
+using fair_mutex = mtx::basic_shared_futex_mutex<mtx::park_wait_policy, Fairness>;
+
+TEST(lock_fairness, reader_preferring_ignores_waiting_writers)
+{
+	fair_mutex<mtx::lock_fairness::reader_preferring> mutex;
+	mutex.lock_shared();
+	auto writer = std::async(std::launch::async, [&]() {
+		mutex.lock();
+		mutex.unlock();
+	});
+	std::this_thread::sleep_for(20ms);
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock_shared());
+		mutex.unlock_shared();
+	}).get();
+	mutex.unlock_shared();
+	writer.get();
+}
+
+TEST(lock_fairness, writer_preferring_blocks_new_readers)
+{
+	fair_mutex<mtx::lock_fairness::writer_preferring> mutex;
+	mutex.lock_shared();
+	auto writer = std::async(std::launch::async, [&]() {
+		mutex.lock();
+		mutex.unlock();
+	});
+	std::this_thread::sleep_for(20ms);
+	std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock_shared()); }).get();
+	mutex.unlock_shared();
+	writer.get();
+}
+
+TEST(lock_fairness, phase_fair_lets_waiting_readers_in_before_the_next_writer)
+{
+	fair_mutex<mtx::lock_fairness::phase_fair> mutex;
+	std::atomic<bool> written = false;
+	mutex.lock();
+	auto reader = std::async(std::launch::async, [&]() {
+		mutex.lock_shared();
+		std::this_thread::sleep_for(20ms);
+		EXPECT_FALSE(written);
+		mutex.unlock_shared();
+	});
+	std::this_thread::sleep_for(20ms);
+	auto writer = std::async(std::launch::async, [&]() {
+		mutex.lock();
+		written = true;
+		mutex.unlock();
+	});
+	std::this_thread::sleep_for(20ms);
+	//the waiting writer blocks new readers
+	EXPECT_FALSE(mutex.try_lock_shared());
+	mutex.unlock();
+	reader.get();
+	writer.get();
+	EXPECT_TRUE(written);
+}
+
+TEST(lock_fairness, phase_fair_timed_out_reader_leaves_the_queue)
+{
+	fair_mutex<mtx::lock_fairness::phase_fair> mutex;
+	mutex.lock();
+	std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock_shared_for(10ms)); }).get();
+	mutex.unlock();
+	//no reader owns the lock after the unlock
+	EXPECT_TRUE(mutex.try_lock());
+	mutex.unlock();
+}
+
+TEST(lock_fairness, phase_fair_timed_out_writer_lets_readers_in)
+{
+	fair_mutex<mtx::lock_fairness::phase_fair> mutex;
+	mutex.lock_shared();
+	auto writer = std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock_for(40ms)); });
+	std::this_thread::sleep_for(20ms);
+	std::async(std::launch::async, [&]() {
+		mutex.lock_shared();
+		mutex.unlock_shared();
+	}).get();
+	writer.get();
+	mutex.unlock_shared();
+	EXPECT_TRUE(mutex.try_lock());
+	mutex.unlock();
+}
+
+TEST(lock_fairness, phase_fair_reader_count_does_not_overflow)
+{
+	fair_mutex<mtx::lock_fairness::phase_fair> mutex;
+	//the backend counts every shared ownership, so one thread can use up all reader bits
+	constexpr int maxReaders = (1 << 14) - 1;
+	for (int i = 0; i < maxReaders; ++i)
+		mutex.lock_shared();
+	EXPECT_FALSE(mutex.try_lock_shared());
+	EXPECT_FALSE(mutex.try_lock_upgrade());
+	EXPECT_FALSE(mutex.try_lock());
+	//the next reader waits instead of overflowing into the waiting reader bits and gets in once an owner leaves
+	auto reader = std::async(std::launch::async, [&]() {
+		mutex.lock_shared();
+		mutex.unlock_shared();
+	});
+	EXPECT_EQ(reader.wait_for(20ms), std::future_status::timeout);
+	mutex.unlock_shared();
+	reader.get();
+	for (int i = 1; i < maxReaders; ++i)
+		mutex.unlock_shared();
+	EXPECT_TRUE(mutex.try_lock());
+	mutex.unlock();
+}
+
+TEST(lock_fairness, phase_fair_uncontended_lock_after_a_phase_change)
+{
+	mtx::basic_shared_futex_mutex<mtx::adaptive_spin_wait_policy<>, mtx::lock_fairness::phase_fair> mutex;
+	//the waiting reader is let in by the unlock, which changes the phase
+	mutex.lock();
+	auto reader = std::async(std::launch::async, [&]() {
+		mutex.lock_shared();
+		mutex.unlock_shared();
+	});
+	std::this_thread::sleep_for(20ms);
+	mutex.unlock();
+	reader.get();
+	//an uncontended lock takes the fast path, so it isn't counted as contended acquisition
+	const auto before = mutex.wait_policy().statistics();
+	for (int i = 0; i < 10; ++i)
+	{
+		mutex.lock();
+		mutex.unlock();
+	}
+	const auto after = mutex.wait_policy().statistics();
+	EXPECT_EQ(after.spinAcquisitions, before.spinAcquisitions);
+	EXPECT_EQ(after.parkAcquisitions, before.parkAcquisitions);
+}
+
+TEST(lock_fairness, phase_fair_timed_out_writer_does_not_overflow_the_reader_count)
+{
+	fair_mutex<mtx::lock_fairness::phase_fair> mutex;
+	constexpr int maxReaders = (1 << 14) - 1;
+	constexpr int owners = maxReaders - 10;
+	for (int i = 0; i < owners; ++i)
+		mutex.lock_shared();
+	auto writer = std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock_for(100ms)); });
+	std::this_thread::sleep_for(20ms);
+	//only 10 of them fit into the reader bits when the writer gives up and lets the waiting readers in
+	std::atomic<int> reading{ 0 };
+	std::promise<void> release;
+	std::shared_future<void> released = release.get_future().share();
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 20; ++i)
+	{
+		readers.emplace_back([&]() {
+			mutex.lock_shared();
+			++reading;
+			released.wait();
+			mutex.unlock_shared();
+		});
+	}
+	writer.get();
+	const auto wait_for_readers = [&](int count) {
+		const auto deadline = std::chrono::steady_clock::now() + 5s;
+		while (reading < count && std::chrono::steady_clock::now() < deadline)
+			std::this_thread::sleep_for(1ms);
+	};
+	wait_for_readers(10);
+	std::this_thread::sleep_for(20ms);
+	EXPECT_EQ(reading, 10);
+	for (int i = 0; i < owners; ++i)
+		mutex.unlock_shared();
+	wait_for_readers(20);
+	EXPECT_EQ(reading, 20);
+	release.set_value();
+	for (auto& reader : readers)
+		reader.join();
+	EXPECT_TRUE(mutex.try_lock());
+	mutex.unlock();
+}
@@ -0,0 +1,154 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/left_right.hpp>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+
+using namespace std::chrono_literals;
+
+TEST(left_right, mutation_is_applied_to_both_instances)
+{
+	mtx::left_right<std::vector<int>, struct LeftRightApplyType> protectedValue(std::in_place);
+	int mutations = 0;
+	protectedValue.modify([&](std::vector<int>& value) { ++mutations; value.push_back(1); });
+	EXPECT_EQ(mutations, 2);
+	protectedValue.modify([](std::vector<int>& value) { value.push_back(2); });
+	//the readers switch to the other instance with every modify, both have to be up to date
+	EXPECT_EQ(protectedValue.read([](const std::vector<int>& value) { return value; }), (std::vector<int>{ 1, 2 }));
+	protectedValue.modify([](std::vector<int>& value) { value.push_back(3); });
+	EXPECT_EQ(protectedValue.read([](const std::vector<int>& value) { return value.size(); }), 3u);
+}
+
+TEST(left_right, recursive_modify)
+{
+	using protected_type = mtx::left_right<int, struct LeftRightRecursiveType>;
+	protected_type protectedValue(0);
+	int inner = 0;
+	protectedValue.modify([&](int& value) {
+		value += 1;
+		//applied to the instance that is being mutated, so it runs once per instance as well
+		protectedValue.modify([&](int& nested) { ++inner; nested += 10; });
+	});
+	EXPECT_EQ(inner, 2);
+	EXPECT_EQ(protectedValue.read([](int value) { return value; }), 11);
+	{
+		//a thread with write ownership can modify, other writers have to wait
+		std::unique_lock write_guard(protected_type::mutex_type::instance());
+		auto writer = std::async(std::launch::async, [&]() { protectedValue.modify([](int& value) { value *= 2; }); });
+		EXPECT_EQ(writer.wait_for(20ms), std::future_status::timeout);
+		protectedValue.modify([](int& value) { value += 1; });
+		write_guard.unlock();
+		writer.get();
+	}
+	EXPECT_EQ(protectedValue.read([](int value) { return value; }), 24);
+}
+
+TEST(left_right, throwing_mutation_keeps_instances_equal)
+{
+	using protected_type = mtx::left_right<std::vector<int>, struct LeftRightThrowType>;
+	protected_type protectedValue(std::in_place);
+	//every modify switches the readers to the other instance, so two reads after empty modifies see both instances
+	const auto both_instances = [&]() {
+		std::vector<std::vector<int>> instances;
+		for (int i = 0; i < 2; ++i)
+		{
+			protectedValue.modify([](std::vector<int>&) {});
+			instances.push_back(protectedValue.read([](const std::vector<int>& value) { return value; }));
+		}
+		return instances;
+	};
+	protectedValue.modify([](std::vector<int>& value) { value.push_back(1); });
+
+	//throws on the first instance after a partial mutation, the modify has no effect
+	EXPECT_THROW(protectedValue.modify([](std::vector<int>& value) {
+		value.push_back(2);
+		throw std::runtime_error("first");
+	}), std::runtime_error);
+	EXPECT_EQ(both_instances(), (std::vector<std::vector<int>>{ { 1 }, { 1 } }));
+
+	//throws on the second instance, the readers already see the mutated one
+	int calls = 0;
+	EXPECT_THROW(protectedValue.modify([&](std::vector<int>& value) {
+		value.push_back(3);
+		if (++calls == 2)
+			throw std::runtime_error("second");
+	}), std::runtime_error);
+	EXPECT_EQ(both_instances(), (std::vector<std::vector<int>>{ { 1, 3 }, { 1, 3 } }));
+
+	//a nested modify that throws out of the outer mutation
+	EXPECT_THROW(protectedValue.modify([&](std::vector<int>& value) {
+		value.push_back(4);
+		protectedValue.modify([](std::vector<int>& nested) {
+			nested.push_back(5);
+			throw std::runtime_error("nested");
+		});
+	}), std::runtime_error);
+	EXPECT_EQ(both_instances(), (std::vector<std::vector<int>>{ { 1, 3 }, { 1, 3 } }));
+
+	//the write lock has been released and the next modify isn't mistaken for a nested one
+	std::async(std::launch::async, [&]() { protectedValue.modify([](std::vector<int>& value) { value.push_back(6); }); }).get();
+	EXPECT_EQ(both_instances(), (std::vector<std::vector<int>>{ { 1, 3, 6 }, { 1, 3, 6 } }));
+	EXPECT_FALSE(protected_type::mutex_type::instance().is_locked());
+}
+
+TEST(left_right, writer_waits_for_reader_of_old_instance)
+{
+	mtx::left_right<int, struct LeftRightWaitType> protectedValue(1);
+	std::promise<void> inside;
+	std::promise<void> release;
+	auto reader = std::async(std::launch::async, [&]() {
+		return protectedValue.read([&](int value) {
+			inside.set_value();
+			release.get_future().wait();
+			return value;
+		});
+	});
+	inside.get_future().wait();
+	auto writer = std::async(std::launch::async, [&]() { protectedValue.modify([](int& value) { value = 2; }); });
+	EXPECT_EQ(writer.wait_for(20ms), std::future_status::timeout);
+	//new readers already see the new value while the writer waits
+	EXPECT_EQ(protectedValue.read([](int value) { return value; }), 2);
+	release.set_value();
+	EXPECT_EQ(reader.get(), 1);
+	writer.get();
+	EXPECT_EQ(protectedValue.read([](int value) { return value; }), 2);
+}
+
+TEST(left_right, concurrent_readers_and_writers)
+{
+	struct pair
+	{
+		uint64_t first = 0;
+		uint64_t second = 0;
+	};
+	mtx::left_right<pair, struct LeftRightStressType> protectedValue(std::in_place);
+	std::atomic<bool> done{ false };
+	std::atomic<uint64_t> torn{ 0 };
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 4; ++i)
+	{
+		readers.emplace_back([&]() {
+			while (!done.load(std::memory_order_relaxed))
+			{
+				protectedValue.read([&](const pair& value) {
+					if (value.first != value.second)
+						++torn;
+				});
+			}
+		});
+	}
+	for (uint64_t i = 1; i <= 2000; ++i)
+		protectedValue.modify([](pair& value) { ++value.first; ++value.second; });
+	done = true;
+	for (auto& reader : readers)
+		reader.join();
+	EXPECT_EQ(torn, 0u);
+	EXPECT_EQ(protectedValue.read([](const pair& value) { return value.first; }), 2000u);
+}
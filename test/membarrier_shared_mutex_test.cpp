@@ -0,0 +1,105 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/membarrier_shared_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+	struct test_record
+	{
+		int value = 0;
+	};
+}
+
+TEST(thread_registry, records_are_reused)
+{
+	using registry = mtx::detail::thread_registry<test_record>;
+	auto countRecords = []() {
+		int count = 0;
+		registry::for_each([&](const test_record&) { ++count; });
+		return count;
+	};
+	std::thread([]() { registry::local().value = 1; }).join();
+	const int records = countRecords();
+	EXPECT_GE(records, 1);
+	//the thread above is gone, so the next thread gets its record
+	std::thread([]() { EXPECT_EQ(registry::local().value, 1); }).join();
+	EXPECT_EQ(countRecords(), records);
+}
+
+TEST(membarrier_shared_mutex, writer_waits_for_readers)
+{
+	mtx::membarrier_shared_mutex mutex;
+	mutex.lock_shared();
+	std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock()); }).get();
+	std::atomic<bool> written{ false };
+	auto writer = std::async(std::launch::async, [&]() {
+		std::unique_lock lock(mutex);
+		written = true;
+	});
+	std::this_thread::sleep_for(20ms);
+	EXPECT_FALSE(written);
+	mutex.unlock_shared();
+	writer.get();
+	EXPECT_TRUE(written);
+}
+
+TEST(membarrier_shared_mutex, more_mutexes_than_slots)
+{
+	std::array<mtx::membarrier_shared_mutex, 12> mutexes;
+	for (auto& mutex : mutexes)
+		mutex.lock_shared();
+	std::async(std::launch::async, [&]() {
+		for (auto& mutex : mutexes)
+			EXPECT_FALSE(mutex.try_lock());
+	}).get();
+	for (auto& mutex : mutexes)
+		mutex.unlock_shared();
+	std::async(std::launch::async, [&]() {
+		for (auto& mutex : mutexes)
+		{
+			EXPECT_TRUE(mutex.try_lock());
+			mutex.unlock();
+		}
+	}).get();
+}
+
+TEST(membarrier_shared_mutex, concurrent_counter)
+{
+	constexpr int numThreads = 8;
+	constexpr int numIterations = 5000;
+	auto& mutex = mtx::shared_recursive_membarrier_mutex_t<struct MembarrierTestType>::instance();
+	int counter = 0;
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				std::shared_lock read_guard(mutex);
+				const int before = counter;
+				std::shared_lock read_guard2(mutex);
+				ASSERT_EQ(before, counter);
+				if (i % 500 == 0)
+				{
+					std::unique_lock write_guard(mutex);
+					counter++;
+				}
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	ASSERT_EQ(counter, numThreads * (numIterations / 500));
+}
@@ -0,0 +1,131 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/versioned_shared_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+
+TEST(optimistic_read, writer_invalidates_read)
+{
+	mtx::basic_shared_recursive_mutex<mtx::versioned_shared_mutex<>> mutex;
+	auto token = mutex.read_begin();
+	EXPECT_EQ(token.mode, mtx::read_token::kind::optimistic);
+	//an optimistic reader doesn't own the mutex
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock());
+		mutex.unlock();
+	}).get();
+	EXPECT_FALSE(mutex.read_validate(token));
+	token = mutex.read_begin();
+	EXPECT_TRUE(mutex.read_validate(token));
+}
+
+TEST(optimistic_read, active_writer_and_failures_fall_back_to_lock)
+{
+	mtx::basic_shared_recursive_mutex<mtx::versioned_shared_mutex<mtx::shared_futex_mutex, 2>> mutex;
+	for (int i = 0; i < 2; ++i)
+	{
+		auto token = mutex.read_begin();
+		ASSERT_EQ(token.mode, mtx::read_token::kind::optimistic);
+		std::async(std::launch::async, [&]() { std::unique_lock lock(mutex); }).get();
+		EXPECT_FALSE(mutex.read_validate(token));
+	}
+	auto token = mutex.read_begin();
+	EXPECT_EQ(token.mode, mtx::read_token::kind::locked);
+	EXPECT_TRUE(mutex.is_locked_shared());
+	std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock()); }).get();
+	EXPECT_TRUE(mutex.read_validate(token));
+	EXPECT_FALSE(mutex.is_locked_shared());
+	//a successful read resets the failures
+	token = mutex.read_begin();
+	EXPECT_EQ(token.mode, mtx::read_token::kind::optimistic);
+	EXPECT_TRUE(mutex.read_validate(token));
+
+	//a writer owns the mutex, the reader doesn't even try to read optimistically
+	mutex.backend().lock();
+	std::promise<void> started;
+	auto reader = std::async(std::launch::async, [&]() {
+		started.set_value();
+		auto blockedToken = mutex.read_begin();
+		EXPECT_EQ(blockedToken.mode, mtx::read_token::kind::locked);
+		EXPECT_TRUE(mutex.read_validate(blockedToken));
+	});
+	started.get_future().wait();
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	mutex.backend().unlock();
+	reader.get();
+}
+
+TEST(optimistic_read, owned_mutex_is_always_valid)
+{
+	auto& mutex = mtx::shared_recursive_versioned_mutex_t<struct OptimisticNestedType>::instance();
+	{
+		std::shared_lock read_guard(mutex);
+		auto token = mutex.read_begin();
+		EXPECT_EQ(token.mode, mtx::read_token::kind::nested);
+		EXPECT_TRUE(mutex.read_validate(token));
+		EXPECT_TRUE(mutex.is_locked_shared());
+	}
+	{
+		std::unique_lock write_guard(mutex);
+		auto token = mutex.read_begin();
+		EXPECT_EQ(token.mode, mtx::read_token::kind::nested);
+		EXPECT_TRUE(mutex.read_validate(token));
+		EXPECT_TRUE(mutex.is_locked());
+	}
+}
+
+TEST(optimistic_read, backend_without_versions_locks)
+{
+	mtx::basic_shared_recursive_mutex<std::shared_mutex> mutex;
+	auto token = mutex.read_begin();
+	EXPECT_EQ(token.mode, mtx::read_token::kind::locked);
+	EXPECT_TRUE(mutex.is_locked_shared());
+	EXPECT_TRUE(mutex.read_validate(token));
+	EXPECT_FALSE(mutex.is_locked_shared());
+}
+
+TEST(optimistic_read, readers_never_see_torn_state)
+{
+	constexpr int numReaders = 4;
+	constexpr int numWrites = 2000;
+	auto& mutex = mtx::shared_recursive_versioned_mutex_t<struct OptimisticCounterType>::instance();
+	//the writer keeps second == 2 * first, a validated read must never see anything else
+	std::atomic<int> first{ 0 };
+	std::atomic<int> second{ 0 };
+	std::atomic<bool> done{ false };
+	std::array<std::future<void>, numReaders> readers;
+	for (auto& future : readers)
+	{
+		future = std::async(std::launch::async, [&]() {
+			while (!done)
+			{
+				int a = 0;
+				int b = 0;
+				mtx::read_token token;
+				do
+				{
+					token = mutex.read_begin();
+					a = first.load(std::memory_order_relaxed);
+					b = second.load(std::memory_order_relaxed);
+				} while (!mutex.read_validate(token));
+				ASSERT_EQ(b, 2 * a);
+			}
+		});
+	}
+	for (int i = 1; i <= numWrites; ++i)
+	{
+		std::unique_lock write_guard(mutex);
+		first.store(i, std::memory_order_relaxed);
+		second.store(2 * i, std::memory_order_relaxed);
+	}
+	done = true;
+	for (auto& future : readers)
+		future.get();
+}
@@ -0,0 +1,111 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/phase_fair_ticket_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+
+using namespace std::chrono_literals;
+
+TEST(phase_fair_ticket_mutex, waiting_writer_ends_reader_phase)
+{
+	mtx::phase_fair_ticket_mutex mutex;
+	mutex.lock_shared();
+	std::atomic<bool> written{ false };
+	auto writer = std::async(std::launch::async, [&]() {
+		std::unique_lock lock(mutex);
+		written = true;
+	});
+	//as soon as the writer has its ticket, new readers have to wait for the next reader phase
+	while (mutex.try_lock_shared())
+	{
+		mutex.unlock_shared();
+		std::this_thread::yield();
+	}
+	EXPECT_FALSE(written);
+	std::atomic<bool> read{ false };
+	auto reader = std::async(std::launch::async, [&]() {
+		std::shared_lock lock(mutex);
+		read = true;
+		EXPECT_TRUE(written);
+	});
+	std::this_thread::sleep_for(20ms);
+	EXPECT_FALSE(read);
+	mutex.unlock_shared();
+	writer.get();
+	reader.get();
+	EXPECT_TRUE(read);
+	EXPECT_TRUE(mutex.try_lock());
+	mutex.unlock();
+}
+
+TEST(phase_fair_ticket_mutex, nested_reads_take_no_ticket)
+{
+	auto& mutex = mtx::shared_recursive_ticket_mutex_t<struct TicketTestType>::instance();
+	std::shared_lock read_guard(mutex);
+	auto writer = std::async(std::launch::async, [&]() {
+		std::unique_lock lock(mutex);
+	});
+	while (mutex.backend().try_lock_shared())
+	{
+		mutex.backend().unlock_shared();
+		std::this_thread::yield();
+	}
+	//the writer waits for us, re-entering the read lock must not queue behind it
+	{
+		std::shared_lock nested_read_guard(mutex);
+		EXPECT_TRUE(mutex.is_locked_shared());
+	}
+	read_guard.unlock();
+	writer.get();
+}
+
+TEST(phase_fair_ticket_mutex, failed_try_lock_releases_readers)
+{
+	mtx::phase_fair_ticket_mutex mutex;
+	mutex.lock_shared();
+	std::async(std::launch::async, [&]() {
+		EXPECT_FALSE(mutex.try_lock());
+		EXPECT_TRUE(mutex.try_lock_shared());
+		mutex.unlock_shared();
+	}).get();
+	mutex.unlock_shared();
+	EXPECT_TRUE(mutex.try_lock());
+	EXPECT_FALSE(mutex.try_lock_shared());
+	mutex.unlock();
+}
+
+TEST(phase_fair_ticket_mutex, concurrent_counter)
+{
+	constexpr int numThreads = 8;
+	constexpr int numIterations = 2000;
+	auto& mutex = mtx::shared_recursive_ticket_mutex_t<struct TicketCounterType>::instance();
+	int counter = 0;
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				std::shared_lock read_guard(mutex);
+				const int before = counter;
+				std::shared_lock read_guard2(mutex);
+				ASSERT_EQ(before, counter);
+				read_guard2.unlock();
+				read_guard.unlock();
+				std::unique_lock write_guard(mutex);
+				counter++;
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	ASSERT_EQ(counter, numThreads * numIterations);
+}
@@ -0,0 +1,103 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/queued_shared_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <future>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST(queued_shared_mutex, grants_in_fifo_order)
+{
+	mtx::queued_shared_mutex mutex;
+	std::mutex orderMtx;
+	std::vector<int> order;
+	auto record = [&](int id) {
+		std::lock_guard lock(orderMtx);
+		order.push_back(id);
+	};
+	mutex.lock();
+	//writer, reader, reader, writer queue up behind the owner in this order
+	auto first = std::async(std::launch::async, [&]() { std::unique_lock lock(mutex); record(1); });
+	std::this_thread::sleep_for(20ms);
+	auto second = std::async(std::launch::async, [&]() { std::shared_lock lock(mutex); record(2); std::this_thread::sleep_for(10ms); });
+	std::this_thread::sleep_for(20ms);
+	auto third = std::async(std::launch::async, [&]() { std::shared_lock lock(mutex); record(3); std::this_thread::sleep_for(10ms); });
+	std::this_thread::sleep_for(20ms);
+	auto fourth = std::async(std::launch::async, [&]() { std::unique_lock lock(mutex); record(4); });
+	std::this_thread::sleep_for(20ms);
+	EXPECT_FALSE(mutex.try_lock_shared());
+	mutex.unlock();
+	first.get();
+	second.get();
+	third.get();
+	fourth.get();
+	ASSERT_EQ(order.size(), 4u);
+	EXPECT_EQ(order[0], 1);
+	EXPECT_EQ(order[3], 4);
+}
+
+TEST(queued_shared_mutex, concurrent_counter)
+{
+	constexpr int numThreads = 8;
+	constexpr int numIterations = 2000;
+	auto& mutex = mtx::shared_recursive_queued_mutex_t<struct QueuedTestType>::instance();
+	mtx::queued_shared_mutex other;
+	int counter = 0;
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				std::shared_lock read_guard(mutex);
+				if (i % 20 == 0)
+				{
+					std::unique_lock write_guard(mutex);
+					//the node of the thread is free again as soon as it owns the lock
+					std::shared_lock other_guard(other);
+					counter++;
+				}
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	ASSERT_EQ(counter, numThreads * numIterations / 20);
+}
+
+#if !defined(_WIN32)
+TEST(queued_shared_mutex, head_of_the_queue_parks)
+{
+	//std::clock measures the cpu time of the process (on windows it's the wall time), the waiting head must not burn it
+	mtx::queued_shared_mutex mutex;
+	const std::clock_t start = std::clock();
+	mutex.lock_shared();
+	auto writer = std::async(std::launch::async, [&]() {
+		mutex.lock();
+		mutex.unlock();
+	});
+	std::this_thread::sleep_for(200ms);
+	mutex.unlock_shared();
+	writer.get();
+	mutex.lock();
+	auto reader = std::async(std::launch::async, [&]() {
+		mutex.lock_shared();
+		mutex.unlock_shared();
+	});
+	std::this_thread::sleep_for(200ms);
+	mutex.unlock();
+	reader.get();
+	const double seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+	EXPECT_LT(seconds, 0.1);
+}
+#endif
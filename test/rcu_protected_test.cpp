@@ -0,0 +1,158 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/rcu_protected.hpp>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <future>
+
+namespace
+{
+	std::atomic<int> g_liveVersions{ 0 };
+
+	struct tracked
+	{
+		explicit tracked(int v) : value(v) { ++g_liveVersions; }
+		tracked(const tracked& other) : value(other.value) { ++g_liveVersions; }
+		~tracked() { --g_liveVersions; }
+
+		int value;
+	};
+}
+
+TEST(rcu_protected, reader_keeps_its_version)
+{
+	{
+		mtx::rcu_protected<tracked, struct RcuKeepType> protectedValue(std::in_place, 1);
+		{
+			auto reader = protectedValue.read();
+			EXPECT_EQ(reader->value, 1);
+			std::async(std::launch::async, [&]() { protectedValue.update_copy([](tracked& value) { value.value = 2; }); }).get();
+			//the old version can't be reclaimed while we read it
+			EXPECT_EQ(reader->value, 1);
+			EXPECT_EQ(g_liveVersions, 2);
+			EXPECT_EQ(protectedValue.reclaim(), 1u);
+			//a nested read section sees the new version
+			EXPECT_EQ(protectedValue.read()->value, 2);
+		}
+		EXPECT_EQ(protectedValue.reclaim(), 0u);
+		EXPECT_EQ(g_liveVersions, 1);
+		protectedValue.update(std::make_unique<tracked>(3));
+		//no readers, the update reclaims right away
+		EXPECT_EQ(g_liveVersions, 1);
+		EXPECT_EQ(protectedValue.read()->value, 3);
+	}
+	EXPECT_EQ(g_liveVersions, 0);
+}
+
+TEST(rcu_protected, writers_serialize_through_the_mutex)
+{
+	using rcu = mtx::rcu_protected<tracked, struct RcuMutexType>;
+	rcu protectedValue(std::in_place, 0);
+	{
+		std::unique_lock write_guard(rcu::mutex_type::instance());
+		auto writer = std::async(std::launch::async, [&]() { protectedValue.update_copy([](tracked& value) { ++value.value; }); });
+		EXPECT_EQ(writer.wait_for(std::chrono::milliseconds(20)), std::future_status::timeout);
+		//the write lock is recursive, so the owner can update
+		protectedValue.update_copy([](tracked& value) { value.value += 10; });
+		EXPECT_EQ(protectedValue.read()->value, 10);
+		write_guard.unlock();
+		writer.get();
+	}
+	EXPECT_EQ(protectedValue.read()->value, 11);
+}
+
+TEST(rcu_protected, concurrent_readers_and_writers)
+{
+	struct pair
+	{
+		uint64_t first = 0;
+		uint64_t second = 0;
+	};
+	mtx::rcu_protected<pair, struct RcuStressType> protectedValue(std::in_place);
+	std::atomic<bool> done{ false };
+	std::atomic<uint64_t> torn{ 0 };
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 4; ++i)
+	{
+		readers.emplace_back([&]() {
+			while (!done.load(std::memory_order_relaxed))
+			{
+				auto reader = protectedValue.read();
+				if (reader->first != reader->second)
+					++torn;
+				auto nested = protectedValue.read();
+				if (nested->first < reader->first)
+					++torn;
+			}
+		});
+	}
+	for (uint64_t i = 1; i <= 2000; ++i)
+		protectedValue.update_copy([i](pair& value) { value.first = i; value.second = i; });
+	done = true;
+	for (auto& reader : readers)
+		reader.join();
+	protectedValue.synchronize();
+	EXPECT_EQ(torn, 0u);
+	EXPECT_EQ(protectedValue.read()->first, 2000u);
+}
+
+TEST(rcu_protected, concurrent_updates_with_many_readers)
+{
+	//build with shared_recursive_mutex_OPT_SANITIZE_THREAD to let ThreadSanitizer check that no version is deleted while it's read
+	struct version
+	{
+		explicit version(uint64_t v) : value(v), check(~v) {}
+		//a reader of a deleted version would see the poisoned values (if it doesn't crash first)
+		~version() { value = 0; check = 0; }
+
+		uint64_t value;
+		uint64_t check;
+	};
+	mtx::rcu_protected<version, struct RcuConcurrentType> protectedValue(std::in_place, 1);
+	std::atomic<bool> done{ false };
+	std::atomic<uint64_t> broken{ 0 };
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 8; ++i)
+	{
+		threads.emplace_back([&]() {
+			uint64_t last = 0;
+			while (!done.load(std::memory_order_relaxed))
+			{
+				auto reader = protectedValue.read();
+				const uint64_t value = reader->value;
+				if (value == 0 || reader->check != ~value || value < last)
+					++broken;
+				last = value;
+				std::this_thread::yield();
+				//the version has to stay alive for the whole read section
+				if (reader->value != value || reader->check != ~value)
+					++broken;
+			}
+		});
+	}
+	std::atomic<uint64_t> next{ 2 };
+	std::vector<std::thread> writers;
+	for (int i = 0; i < 2; ++i)
+	{
+		writers.emplace_back([&]() {
+			for (int j = 0; j < 500; ++j)
+			{
+				//the counter is incremented with the write lock, so the published values are increasing
+				std::unique_lock write_guard(decltype(protectedValue)::mutex_type::instance());
+				protectedValue.update(std::make_unique<version>(next++));
+			}
+		});
+	}
+	for (auto& writer : writers)
+		writer.join();
+	done = true;
+	for (auto& thread : threads)
+		thread.join();
+	protectedValue.synchronize();
+	EXPECT_EQ(broken, 0u);
+	EXPECT_EQ(protectedValue.read()->value, 1001u);
+}
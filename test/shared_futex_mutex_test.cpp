@@ -0,0 +1,120 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/shared_futex_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <array>
+#include <future>
+#include <chrono>
+
+TEST(shared_futex_mutex, exclusive_excludes_everyone)
+{
+	mtx::shared_futex_mutex mutex;
+	mutex.lock();
+	std::async(std::launch::async, [&]() {
+		EXPECT_FALSE(mutex.try_lock());
+		EXPECT_FALSE(mutex.try_lock_shared());
+	}).get();
+	mutex.unlock();
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock());
+		mutex.unlock();
+	}).get();
+}
+
+TEST(shared_futex_mutex, readers_share_ownership)
+{
+	mtx::shared_futex_mutex mutex;
+	mutex.lock_shared();
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock_shared());
+		EXPECT_FALSE(mutex.try_lock());
+		mutex.unlock_shared();
+	}).get();
+	EXPECT_FALSE(mutex.try_lock());
+	mutex.unlock_shared();
+	EXPECT_TRUE(mutex.try_lock());
+	mutex.unlock();
+}
+
+TEST(shared_futex_mutex, waiting_writer_blocks_new_readers)
+{
+	mtx::shared_futex_mutex mutex;
+	mutex.lock_shared();
+	auto writer = std::async(std::launch::async, [&]() {
+		std::unique_lock lock(mutex);
+	});
+	//wait until the writer has announced itself
+	while (mutex.try_lock_shared())
+	{
+		mutex.unlock_shared();
+		std::this_thread::yield();
+	}
+	mutex.unlock_shared();
+	writer.get();
+	EXPECT_TRUE(mutex.try_lock_shared());
+	mutex.unlock_shared();
+}
+
+template<typename Mutex>
+void run_concurrent_counter(Mutex& mutex)
+{
+	constexpr int numThreads = 8;
+	constexpr int numIterations = 10000;
+	int counter = 0;
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				if (i % 3 == 0)
+				{
+					std::unique_lock lock(mutex);
+					counter++;
+				}
+				else
+				{
+					std::shared_lock lock(mutex);
+					ASSERT_GE(counter, 0);
+				}
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	ASSERT_EQ(counter, numThreads * ((numIterations + 2) / 3));
+}
+
+TEST(shared_futex_mutex, concurrent_counter)
+{
+	mtx::shared_futex_mutex mutex;
+	run_concurrent_counter(mutex);
+}
+
+TEST(shared_futex_mutex, adaptive_spin_concurrent_counter)
+{
+	mtx::basic_shared_futex_mutex<mtx::adaptive_spin_wait_policy<>> mutex;
+	run_concurrent_counter(mutex);
+	const auto statistics = mutex.wait_policy().statistics();
+	EXPECT_LE(statistics.spinAcquisitions + statistics.parkAcquisitions, 8u * 10000u);
+}
+
+TEST(shared_futex_mutex, adaptive_spin_parks_for_long_critical_sections)
+{
+	mtx::basic_shared_futex_mutex<mtx::adaptive_spin_wait_policy<>> mutex;
+	mutex.lock();
+	auto reader = std::async(std::launch::async, [&]() {
+		mutex.lock_shared();
+		mutex.unlock_shared();
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	mutex.unlock();
+	reader.get();
+	EXPECT_EQ(mutex.wait_policy().statistics().parkAcquisitions, 1u);
+	EXPECT_EQ(mutex.wait_policy().statistics().spinAcquisitions, 0u);
+}
@@ -0,0 +1,119 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/shared_spin_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <array>
+#include <future>
+#include <chrono>
+#include <type_traits>
+
+TEST(shared_spin_mutex, upgrade_coexists_with_readers)
+{
+	mtx::shared_spin_mutex mutex;
+	mutex.lock_upgrade();
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock_shared());
+		EXPECT_FALSE(mutex.try_lock_upgrade());
+		EXPECT_FALSE(mutex.try_lock());
+		mutex.unlock_shared();
+	}).get();
+	mutex.unlock_upgrade_and_lock();
+	std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock_shared()); }).get();
+	mutex.unlock_and_lock_upgrade();
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock_shared());
+		mutex.unlock_shared();
+	}).get();
+	mutex.unlock_upgrade_and_lock_shared();
+	EXPECT_TRUE(mutex.try_unlock_shared_and_lock());
+	mutex.unlock_and_lock_shared();
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock_upgrade());
+		mutex.unlock_upgrade();
+	}).get();
+	mutex.unlock_shared();
+	EXPECT_TRUE(mutex.try_lock());
+	mutex.unlock();
+}
+
+TEST(shared_spin_mutex, promotion_waits_for_readers)
+{
+	mtx::shared_spin_mutex mutex;
+	mutex.lock_shared();
+	auto upgrader = std::async(std::launch::async, [&]() {
+		mutex.lock_upgrade();
+		EXPECT_FALSE(mutex.try_unlock_upgrade_and_lock());
+		mutex.unlock_upgrade_and_lock();
+		mutex.unlock();
+	});
+	//the promotion blocks new readers while it waits
+	while (mutex.try_lock_shared())
+	{
+		mutex.unlock_shared();
+		std::this_thread::yield();
+	}
+	mutex.unlock_shared();
+	upgrader.get();
+}
+
+TEST(shared_spin_mutex, concurrent_counter)
+{
+	constexpr int numThreads = 4;
+	constexpr int numIterations = 2000;
+	auto& mutex = mtx::shared_recursive_spin_mutex_t<struct SpinTestType>::instance();
+	int counter = 0;
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				mtx::upgrade_lock upgrade_guard(mutex);
+				std::shared_lock read_guard(mutex);
+				const int before = counter;
+				if (i % 2 == 0)
+				{
+					mtx::upgrade_to_unique_lock write_guard(upgrade_guard);
+					counter = before + 1;
+				}
+				else
+				{
+					std::unique_lock write_guard(mutex);
+					counter++;
+				}
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	ASSERT_EQ(counter, numThreads * numIterations);
+}
+
+TEST(shared_spin_mutex, recursion_layer_never_yields)
+{
+	static_assert(mtx::detail::never_enters_kernel_v<mtx::shared_spin_mutex>);
+	static_assert(std::is_same_v<mtx::detail::backoff_for<mtx::shared_spin_mutex>, mtx::detail::spin_backoff<>>);
+	static_assert(std::is_same_v<mtx::detail::backoff_for<mtx::shared_futex_mutex>, mtx::detail::backoff<>>);
+	//combine polls the backend with the spin backoff while another thread holds a read lock
+	auto& mutex = mtx::shared_recursive_spin_mutex_t<struct SpinCombineType>::instance();
+	int counter = 0;
+	std::promise<void> reading;
+	std::promise<void> release;
+	auto reader = std::async(std::launch::async, [&]() {
+		std::shared_lock read_guard(mutex);
+		reading.set_value();
+		release.get_future().wait();
+	});
+	reading.get_future().wait();
+	auto combiner = std::async(std::launch::async, [&]() { mutex.combine([&]() { ++counter; }); });
+	EXPECT_EQ(combiner.wait_for(std::chrono::milliseconds(20)), std::future_status::timeout);
+	release.set_value();
+	reader.get();
+	combiner.get();
+	EXPECT_EQ(counter, 1);
+}
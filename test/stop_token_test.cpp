@@ -0,0 +1,170 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <chrono>
+#include <thread>
+#include <future>
+#include <vector>
+
+#if defined(__cpp_lib_jthread)
+
+using namespace std::chrono_literals;
+
+TEST(shared_futex_mutex, stop_while_waiting)
+{
+	mtx::shared_futex_mutex mutex;
+	mutex.lock_shared();
+	std::stop_source stop;
+	std::jthread writer([&]() { EXPECT_FALSE(mutex.lock(stop.get_token())); });
+	std::this_thread::sleep_for(10ms);
+	stop.request_stop();
+	writer.join();
+	//the writer that gave up doesn't block new readers
+	std::jthread([&]() {
+		EXPECT_TRUE(mutex.try_lock_shared());
+		mutex.unlock_shared();
+	}).join();
+	mutex.unlock_shared();
+	EXPECT_TRUE(mutex.lock_shared(stop.get_token()));
+	mutex.unlock_shared();
+}
+
+TEST(shared_futex_mutex, uncontended_lock_after_a_stop)
+{
+	mtx::basic_shared_futex_mutex<mtx::adaptive_spin_wait_policy<>> mutex;
+	mutex.lock_shared();
+	std::stop_source stop;
+	std::jthread writer([&]() { EXPECT_FALSE(mutex.lock(stop.get_token())); });
+	std::this_thread::sleep_for(10ms);
+	//the stop toggles the notify bit of the state word once
+	stop.request_stop();
+	writer.join();
+	mutex.unlock_shared();
+	//an uncontended lock takes the fast path, so it isn't counted as contended acquisition
+	const auto before = mutex.wait_policy().statistics();
+	for (int i = 0; i < 10; ++i)
+	{
+		mutex.lock();
+		mutex.unlock();
+	}
+	const auto after = mutex.wait_policy().statistics();
+	EXPECT_EQ(after.spinAcquisitions, before.spinAcquisitions);
+	EXPECT_EQ(after.parkAcquisitions, before.parkAcquisitions);
+}
+
+template<typename Mutex>
+void check_stop_recursion(Mutex& mutex)
+{
+	mutex.lock();
+	std::jthread reader([&](std::stop_token stop) {
+		EXPECT_FALSE(mutex.lock_shared(stop));
+		EXPECT_FALSE(mutex.is_locked_shared());
+	});
+	std::this_thread::sleep_for(10ms);
+	reader.request_stop();
+	reader.join();
+	mutex.unlock();
+
+	std::stop_source stop;
+	std::promise<void> reading;
+	mutex.lock_shared();
+	std::jthread otherReader([&](std::stop_token otherStop) {
+		std::shared_lock read_guard(mutex);
+		reading.set_value();
+		while (!otherStop.stop_requested())
+			std::this_thread::sleep_for(1ms);
+	});
+	reading.get_future().wait();
+	std::jthread stopper([&]() {
+		std::this_thread::sleep_for(10ms);
+		stop.request_stop();
+	});
+	//gives up the read ownership to wait for the write ownership and gets it back after the stop
+	EXPECT_FALSE(mutex.lock(stop.get_token()));
+	EXPECT_TRUE(mutex.is_locked_shared());
+	otherReader.request_stop();
+	otherReader.join();
+	EXPECT_TRUE(mutex.lock(std::stop_token()));
+	EXPECT_TRUE(mutex.lock(std::stop_token()));
+	mutex.unlock();
+	mutex.unlock();
+	mutex.unlock_shared();
+	EXPECT_FALSE(mutex.is_locked_shared());
+}
+
+TEST(shared_recursive_mutex, stop_while_waiting)
+{
+	mtx::shared_recursive_mutex mutex;
+	check_stop_recursion(mutex);
+	check_stop_recursion(mtx::shared_recursive_mutex_t<struct StoppableStdType, std::shared_mutex>::instance());
+}
+
+TEST(shared_recursive_mutex, stoppable_promotion_under_read_load)
+{
+	mtx::shared_recursive_mutex mutex;
+	mutex.lock_upgradeable();
+	//the readers overlap, so there is always one of them that owns the mutex unless the waiting writer blocks new readers
+	std::vector<std::jthread> readers;
+	for (int i = 0; i < 2; ++i)
+	{
+		readers.emplace_back([&](std::stop_token readerStop) {
+			while (!readerStop.stop_requested())
+			{
+				std::shared_lock read_guard(mutex);
+				std::this_thread::sleep_for(1ms);
+			}
+		});
+	}
+	std::this_thread::sleep_for(10ms);
+	std::stop_source stop;
+	std::jthread watchdog([&](std::stop_token watchdogStop) {
+		const auto deadline = std::chrono::steady_clock::now() + 10s;
+		while (!watchdogStop.stop_requested() && std::chrono::steady_clock::now() < deadline)
+			std::this_thread::sleep_for(1ms);
+		stop.request_stop();
+	});
+	EXPECT_TRUE(mutex.lock(stop.get_token()));
+	EXPECT_TRUE(mutex.is_locked());
+	watchdog.request_stop();
+	mutex.unlock();
+	mutex.unlock_upgradeable();
+}
+
+TEST(shared_recursive_mutex, stop_while_promoting)
+{
+	mtx::shared_recursive_mutex mutex;
+	std::promise<void> reading;
+	std::jthread reader([&](std::stop_token readerStop) {
+		std::shared_lock read_guard(mutex);
+		reading.set_value();
+		while (!readerStop.stop_requested())
+			std::this_thread::sleep_for(1ms);
+	});
+	reading.get_future().wait();
+	mutex.lock_upgradeable();
+	std::stop_source stop;
+	std::jthread stopper([&]() {
+		std::this_thread::sleep_for(10ms);
+		stop.request_stop();
+	});
+	//gives up and keeps the upgradeable ownership
+	EXPECT_FALSE(mutex.lock(stop.get_token()));
+	EXPECT_FALSE(mutex.is_locked());
+	//the promotion that gave up doesn't block new readers
+	std::jthread([&]() {
+		EXPECT_FALSE(mutex.try_lock_upgradeable());
+		EXPECT_TRUE(mutex.try_lock_shared());
+		mutex.unlock_shared();
+	}).join();
+	reader.request_stop();
+	reader.join();
+	EXPECT_TRUE(mutex.lock(std::stop_token()));
+	mutex.unlock();
+	mutex.unlock_upgradeable();
+}
+
+#endif
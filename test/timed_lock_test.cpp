@@ -0,0 +1,97 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <chrono>
+#include <future>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(shared_futex_mutex, timed_lock_times_out)
+{
+	mtx::shared_futex_mutex mutex;
+	mutex.lock();
+	std::async(std::launch::async, [&]() {
+		const auto start = std::chrono::steady_clock::now();
+		EXPECT_FALSE(mutex.try_lock_shared_for(10ms));
+		EXPECT_FALSE(mutex.try_lock_until(std::chrono::system_clock::now() + 10ms));
+		EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+	}).get();
+	auto writer = std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock_for(10s));
+		mutex.unlock();
+	});
+	std::this_thread::sleep_for(5ms);
+	mutex.unlock();
+	writer.get();
+}
+
+TEST(shared_futex_mutex, timed_out_writer_does_not_block_readers)
+{
+	mtx::shared_futex_mutex mutex;
+	mutex.lock_shared();
+	std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock_for(10ms)); }).get();
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock_shared());
+		mutex.unlock_shared();
+	}).get();
+	mutex.unlock_shared();
+}
+
+template<typename Mutex>
+void check_timed_recursion(Mutex& mutex)
+{
+	{
+		std::unique_lock write_guard(mutex, 10ms);
+		ASSERT_TRUE(write_guard.owns_lock());
+		//re-entry never waits
+		std::unique_lock write_guard2(mutex, 0ms);
+		std::shared_lock read_guard(mutex, 0ms);
+		EXPECT_TRUE(write_guard2.owns_lock());
+		EXPECT_TRUE(read_guard.owns_lock());
+		std::async(std::launch::async, [&]() {
+			EXPECT_FALSE(mutex.try_lock_shared_for(5ms));
+			EXPECT_FALSE(mutex.try_lock_until(std::chrono::steady_clock::now() + 5ms));
+		}).get();
+	}
+	{
+		std::shared_lock read_guard(mutex, std::chrono::steady_clock::now() + 10ms);
+		ASSERT_TRUE(read_guard.owns_lock());
+		EXPECT_TRUE(mutex.try_lock_shared_for(0ms));
+		mutex.unlock_shared();
+		//can't wait for the write lock while holding the read lock
+		EXPECT_FALSE(mutex.try_lock_for(10ms));
+		EXPECT_TRUE(mutex.is_locked_shared());
+	}
+	EXPECT_FALSE(mutex.is_locked_shared());
+}
+
+TEST(shared_recursive_mutex, timed_recursion)
+{
+	mtx::shared_recursive_mutex mutex;
+	check_timed_recursion(mutex);
+	check_timed_recursion(mtx::shared_recursive_mutex_t<struct TimedType, std::shared_timed_mutex>::instance());
+}
+
+TEST(shared_recursive_mutex, timed_upgrade)
+{
+	mtx::shared_recursive_mutex mutex;
+	mtx::upgrade_lock upgrade_guard(mutex);
+	std::promise<void> reading, done;
+	auto reader = std::async(std::launch::async, [&]() {
+		std::shared_lock read_guard(mutex);
+		reading.set_value();
+		done.get_future().wait();
+	});
+	reading.get_future().wait();
+	EXPECT_FALSE(mutex.try_lock_for(10ms));
+	EXPECT_TRUE(mutex.is_locked_upgradeable());
+	done.set_value();
+	reader.get();
+	EXPECT_TRUE(mutex.try_lock_for(10s));
+	mutex.unlock();
+}
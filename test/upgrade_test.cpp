@@ -0,0 +1,221 @@
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+
+#include <gtest/gtest.h>
+#include <shared_recursive_mutex/shared_recursive_mutex.hpp>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <array>
+#include <future>
+#include <atomic>
+#include <chrono>
+
+TEST(shared_futex_mutex, upgrade_coexists_with_readers)
+{
+	mtx::shared_futex_mutex mutex;
+	mutex.lock_upgrade();
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock_shared());
+		EXPECT_FALSE(mutex.try_lock_upgrade());
+		EXPECT_FALSE(mutex.try_lock());
+		mutex.unlock_shared();
+	}).get();
+	mutex.unlock_upgrade_and_lock();
+	std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock_shared()); }).get();
+	mutex.unlock_and_lock_upgrade();
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock_shared());
+		mutex.unlock_shared();
+	}).get();
+	mutex.unlock_upgrade_and_lock_shared();
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock_upgrade());
+		mutex.unlock_upgrade();
+	}).get();
+	mutex.unlock_shared();
+	EXPECT_TRUE(mutex.try_lock());
+	mutex.unlock();
+}
+
+TEST(shared_futex_mutex, promotion_waits_for_readers)
+{
+	mtx::shared_futex_mutex mutex;
+	mutex.lock_shared();
+	auto upgrader = std::async(std::launch::async, [&]() {
+		mutex.lock_upgrade();
+		EXPECT_FALSE(mutex.try_unlock_upgrade_and_lock());
+		mutex.unlock_upgrade_and_lock();
+		mutex.unlock();
+	});
+	//the promotion blocks new readers while it waits
+	while (mutex.try_lock_shared())
+	{
+		mutex.unlock_shared();
+		std::this_thread::yield();
+	}
+	mutex.unlock_shared();
+	upgrader.get();
+}
+
+TEST(shared_recursive_mutex, upgradeable_recursion)
+{
+	mtx::shared_recursive_mutex mutex;
+	{
+		mtx::upgrade_lock upgrade_guard(mutex);
+		std::shared_lock read_guard(mutex);
+		EXPECT_TRUE(mutex.is_locked_upgradeable());
+		EXPECT_FALSE(mutex.is_locked_shared());
+		std::async(std::launch::async, [&]() {
+			EXPECT_TRUE(mutex.try_lock_shared());
+			EXPECT_FALSE(mutex.try_lock_upgradeable());
+			mutex.unlock_shared();
+		}).get();
+		{
+			mtx::upgrade_to_unique_lock write_guard(upgrade_guard);
+			EXPECT_TRUE(mutex.is_locked());
+			mtx::upgrade_lock nested_upgrade_guard(mutex);
+			EXPECT_TRUE(mutex.is_locked());
+			std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock_shared()); }).get();
+		}
+		EXPECT_TRUE(mutex.is_locked_upgradeable());
+	}
+	EXPECT_FALSE(mutex.is_locked_upgradeable());
+	{
+		//read ownership is given up for the upgradeable ownership and reacquired afterwards
+		std::shared_lock read_guard(mutex);
+		{
+			mtx::upgrade_lock upgrade_guard(mutex);
+			EXPECT_TRUE(mutex.is_locked_upgradeable());
+			EXPECT_TRUE(mutex.try_lock());
+			mutex.unlock();
+		}
+		EXPECT_TRUE(mutex.is_locked_shared());
+		EXPECT_FALSE(mutex.try_lock_upgradeable());
+	}
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock());
+		mutex.unlock();
+	}).get();
+}
+
+TEST(shared_recursive_mutex, upgrade_without_invalidation)
+{
+	constexpr int numThreads = 8;
+	constexpr int numIterations = 1000;
+	auto& mutex = mtx::shared_recursive_global_mutex::instance();
+	int counter = 0;
+	std::array<std::future<void>, numThreads> threads;
+	for (auto& future : threads)
+	{
+		future = std::async(std::launch::async, [&]() {
+			for (int i = 0; i < numIterations; ++i)
+			{
+				if (i % 2 == 0)
+				{
+					mtx::upgrade_lock upgrade_guard(mutex);
+					//nobody can write between the read and the write
+					const int value = counter;
+					mtx::upgrade_to_unique_lock write_guard(upgrade_guard);
+					counter = value + 1;
+				}
+				else
+				{
+					std::shared_lock read_guard(mutex);
+					std::unique_lock write_guard(mutex);
+					counter++;
+				}
+			}
+		});
+	}
+	for (auto& future : threads)
+		future.get();
+
+	ASSERT_EQ(counter, numThreads * numIterations);
+}
+
+TEST(shared_recursive_mutex, try_lock_upgrade_in_place)
+{
+	mtx::shared_recursive_mutex mutex;
+	std::shared_lock read_guard(mutex);
+	std::shared_lock read_guard2(mutex);
+	EXPECT_FALSE(mutex.try_lock());
+	{
+		std::unique_lock write_guard(mutex, std::defer_lock);
+		ASSERT_TRUE(mutex.try_lock_upgrade());
+		write_guard = std::unique_lock(mutex, std::adopt_lock);
+		EXPECT_TRUE(mutex.is_locked());
+		std::async(std::launch::async, [&]() { EXPECT_FALSE(mutex.try_lock_shared()); }).get();
+	}
+	EXPECT_TRUE(mutex.is_locked_shared());
+
+	//fails if another thread reads, but keeps the read ownership
+	std::promise<void> reading, done;
+	auto reader = std::async(std::launch::async, [&]() {
+		std::shared_lock other_read_guard(mutex);
+		reading.set_value();
+		done.get_future().wait();
+	});
+	reading.get_future().wait();
+	EXPECT_FALSE(mutex.try_lock_upgrade());
+	EXPECT_TRUE(mutex.is_locked_shared());
+	done.set_value();
+	reader.get();
+	EXPECT_TRUE(mutex.try_lock_upgrade());
+	mutex.unlock();
+}
+
+TEST(shared_recursive_mutex, try_lock_upgrade_without_promotion)
+{
+	auto& mutex = mtx::shared_recursive_mutex_t<struct NoPromotionType, std::shared_mutex>::instance();
+	std::shared_lock read_guard(mutex);
+	EXPECT_FALSE(mutex.try_lock_upgrade());
+	EXPECT_TRUE(mutex.is_locked_shared());
+}
+
+TEST(shared_recursive_mutex, unlock_downgrades_atomically)
+{
+	mtx::shared_recursive_mutex mutex;
+	std::atomic<bool> written = false;
+	mutex.lock_shared();
+	mutex.lock();
+	auto writer = std::async(std::launch::async, [&]() {
+		std::unique_lock write_guard(mutex);
+		written = true;
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	//the waiting writer can't get the mutex while we go back from write to read ownership
+	mutex.unlock();
+	EXPECT_TRUE(mutex.is_locked_shared());
+	EXPECT_FALSE(written);
+	mutex.unlock_shared();
+	writer.get();
+	EXPECT_TRUE(written);
+}
+
+TEST(shared_recursive_mutex, explicit_downgrade)
+{
+	mtx::shared_recursive_mutex mutex;
+	{
+		std::unique_lock write_guard(mutex);
+		std::unique_lock write_guard2(mutex);
+		mutex.downgrade();
+		EXPECT_TRUE(mutex.is_locked_shared());
+		std::async(std::launch::async, [&]() {
+			EXPECT_TRUE(mutex.try_lock_shared());
+			mutex.unlock_shared();
+			EXPECT_FALSE(mutex.try_lock());
+		}).get();
+	}
+	EXPECT_FALSE(mutex.is_locked_shared());
+	{
+		mtx::upgrade_lock upgrade_guard(mutex);
+		std::unique_lock write_guard(mutex);
+		mutex.downgrade();
+		EXPECT_TRUE(mutex.is_locked_upgradeable());
+	}
+	std::async(std::launch::async, [&]() {
+		EXPECT_TRUE(mutex.try_lock());
+		mutex.unlock();
+	}).get();
+}